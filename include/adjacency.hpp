@@ -0,0 +1,358 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <set>
+#include <vector>
+
+#include <cereal/types/set.hpp>
+#include <cereal/types/vector.hpp>
+
+#include "node_pool.hpp"
+
+/**
+ * @brief Neighbor-list stores that can back VtxInfo::out / VtxInfo::in.
+ *
+ * Every store exposes the handful of operations the DCSC kernels need:
+ *   - insert(id), erase(id), contains(id)
+ *   - empty(), size(), clear()
+ *   - forward iteration over the live neighbor ids
+ *   - compact(): fold pending inserts / tombstones into the packed layout
+ *
+ * In the vector and varint stores erasing never moves elements, so their
+ * neighbor lists can be erased from while being walked (YGM may run handlers
+ * from inside an async call). Space held by erased entries is only reclaimed
+ * by compact(), which the kernels call at phase boundaries, never while
+ * iterating. The set store keeps the baseline std::set behaviour: erase frees
+ * the node at once and invalidates any iterator on it, so it must not be
+ * erased from while being walked.
+ *
+ * Each store is a template over the vertex id type; SetAdjacency,
+ * SortedVecAdjacency and VarintAdjacency are the uint32_t ones.
+ */
+
+/// The original node-based layout, kept for comparison. Its nodes come from the rank's NodePool;
+/// unlike the other stores, erase() invalidates iterators to the erased id.
+template <typename VertexId = uint32_t>
+class BasicSetAdjacency {
+public:
+    using value_type = VertexId;
+    using set_type = std::set<VertexId, std::less<VertexId>, PoolAllocator<VertexId>>;
+    using const_iterator = typename set_type::const_iterator;
+
+    void insert(VertexId id) { m_ids.insert(id); }
+    void erase(VertexId id) { m_ids.erase(id); }
+    bool contains(VertexId id) const { return m_ids.count(id) != 0; }
+
+    bool empty() const { return m_ids.empty(); }
+    size_t size() const { return m_ids.size(); }
+    void clear() { m_ids.clear(); }
+    void compact() {}
+
+    const_iterator begin() const { return m_ids.begin(); }
+    const_iterator end() const { return m_ids.end(); }
+
+    template <class Archive>
+    void serialize(Archive& ar) { ar(m_ids); }
+
+private:
+    set_type m_ids;
+};
+
+/**
+ * @brief Sorted std::vector of ids with a tombstone bitmap.
+ *
+ * Inserts are appended to an unsorted tail and merged by compact(), which
+ * also drops duplicates. Erase binary-searches the sorted prefix (then scans
+ * the tail) and sets a tombstone bit.
+ */
+template <typename VertexId = uint32_t>
+class BasicSortedVecAdjacency {
+public:
+    using value_type = VertexId;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = VertexId;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const VertexId*;
+        using reference = const VertexId&;
+
+        const_iterator() = default;
+        const_iterator(const BasicSortedVecAdjacency* adj, size_t pos) : m_adj(adj), m_pos(pos) { skip_dead(); }
+
+        reference operator*() const { return m_adj->m_ids[m_pos]; }
+        const_iterator& operator++() { ++m_pos; skip_dead(); return *this; }
+        const_iterator operator++(int) { auto tmp = *this; ++*this; return tmp; }
+        bool operator==(const const_iterator& o) const { return m_pos == o.m_pos; }
+        bool operator!=(const const_iterator& o) const { return m_pos != o.m_pos; }
+
+    private:
+        void skip_dead() {
+            while (m_pos < m_adj->m_ids.size() && m_adj->is_dead(m_pos)) {
+                ++m_pos;
+            }
+        }
+
+        const BasicSortedVecAdjacency* m_adj = nullptr;
+        size_t m_pos = 0;
+    };
+
+    void insert(VertexId id) {
+        if (m_sorted_end == m_ids.size() && (m_ids.empty() || m_ids.back() < id)) {
+            ++m_sorted_end;
+        }
+        m_ids.push_back(id);
+        ++m_live;
+    }
+
+    // Drops every live copy; duplicates can only sit in the unsorted tail.
+    void erase(VertexId id) {
+        for (size_t pos = find(id); pos != m_ids.size(); pos = find(id)) {
+            if (m_dead.size() * 64 < m_ids.size()) {
+                m_dead.resize((m_ids.size() + 63) / 64, 0);
+            }
+            m_dead[pos / 64] |= (uint64_t(1) << (pos % 64));
+            --m_live;
+        }
+    }
+
+    bool contains(VertexId id) const { return find(id) != m_ids.size(); }
+
+    bool empty() const { return m_live == 0; }
+    size_t size() const { return m_live; }
+
+    void clear() {
+        std::vector<VertexId>().swap(m_ids);
+        std::vector<uint64_t>().swap(m_dead);
+        m_sorted_end = 0;
+        m_live = 0;
+    }
+
+    void compact() {
+        if (m_sorted_end == m_ids.size() && m_dead.empty()) {
+            return;
+        }
+        size_t w = 0;
+        for (size_t r = 0; r < m_ids.size(); ++r) {
+            if (!is_dead(r)) {
+                m_ids[w++] = m_ids[r];
+            }
+        }
+        m_ids.resize(w);
+        std::sort(m_ids.begin(), m_ids.end());
+        m_ids.erase(std::unique(m_ids.begin(), m_ids.end()), m_ids.end());
+        m_ids.shrink_to_fit();
+        std::vector<uint64_t>().swap(m_dead);
+        m_sorted_end = m_ids.size();
+        m_live = m_ids.size();
+    }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, m_ids.size()); }
+
+    template <class Archive>
+    void serialize(Archive& ar) { ar(m_ids, m_dead, m_sorted_end, m_live); }
+
+private:
+    bool is_dead(size_t pos) const {
+        return pos / 64 < m_dead.size() && (m_dead[pos / 64] >> (pos % 64)) & 1;
+    }
+
+    // Position of a live copy of id, or m_ids.size() if there is none.
+    size_t find(VertexId id) const {
+        auto sorted_end = m_ids.begin() + m_sorted_end;
+        auto it = std::lower_bound(m_ids.begin(), sorted_end, id);
+        if (it != sorted_end && *it == id && !is_dead(it - m_ids.begin())) {
+            return it - m_ids.begin();
+        }
+        for (size_t pos = m_sorted_end; pos < m_ids.size(); ++pos) {
+            if (m_ids[pos] == id && !is_dead(pos)) {
+                return pos;
+            }
+        }
+        return m_ids.size();
+    }
+
+    std::vector<VertexId> m_ids;
+    std::vector<uint64_t> m_dead;   // tombstones, allocated on first erase
+    // 32-bit counts keep two lists per vertex 16 bytes smaller; no list holds 2^32 ids
+    uint32_t m_sorted_end = 0;      // m_ids[0, m_sorted_end) is sorted and unique
+    uint32_t m_live = 0;
+};
+
+/**
+ * @brief Delta + LEB128 varint encoded neighbor segment.
+ *
+ * The compacted ids are stored sorted and unique as gaps, so a neighbor list
+ * of clustered ids costs one or two bytes per edge. Inserts are staged in a
+ * plain vector until compact(); erase marks a tombstone by ordinal.
+ */
+template <typename VertexId = uint32_t>
+class BasicVarintAdjacency {
+public:
+    using value_type = VertexId;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = VertexId;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const VertexId*;
+        using reference = const VertexId&;
+
+        const_iterator() = default;
+        const_iterator(const BasicVarintAdjacency* adj, size_t ordinal) : m_adj(adj), m_ordinal(ordinal) {
+            if (m_ordinal == 0) {
+                load();
+            }
+        }
+
+        reference operator*() const { return m_value; }
+        const_iterator& operator++() { ++m_ordinal; load(); return *this; }
+        const_iterator operator++(int) { auto tmp = *this; ++*this; return tmp; }
+        bool operator==(const const_iterator& o) const { return m_ordinal == o.m_ordinal; }
+        bool operator!=(const const_iterator& o) const { return m_ordinal != o.m_ordinal; }
+
+    private:
+        // Decode forward from the current position to the next live entry.
+        void load() {
+            const size_t n_packed = m_adj->m_count;
+            const size_t n_total = n_packed + m_adj->m_pending.size();
+            for (; m_ordinal < n_total; ++m_ordinal) {
+                if (m_ordinal < n_packed) {
+                    m_prev += decode(m_adj->m_bytes, m_offset);
+                    m_value = m_prev;
+                } else {
+                    m_value = m_adj->m_pending[m_ordinal - n_packed];
+                }
+                if (!m_adj->is_dead(m_ordinal)) {
+                    return;
+                }
+            }
+        }
+
+        const BasicVarintAdjacency* m_adj = nullptr;
+        size_t m_ordinal = 0;
+        size_t m_offset = 0;
+        VertexId m_prev = 0;
+        VertexId m_value = 0;
+    };
+
+    void insert(VertexId id) {
+        m_pending.push_back(id);
+        ++m_live;
+    }
+
+    // Drops every live copy; duplicates can only sit in m_pending.
+    void erase(VertexId id) {
+        for (size_t ordinal = find(id); ordinal != npos; ordinal = find(id)) {
+            size_t n_total = m_count + m_pending.size();
+            if (m_dead.size() * 64 < n_total) {
+                m_dead.resize((n_total + 63) / 64, 0);
+            }
+            m_dead[ordinal / 64] |= (uint64_t(1) << (ordinal % 64));
+            --m_live;
+        }
+    }
+
+    bool contains(VertexId id) const { return find(id) != npos; }
+
+    bool empty() const { return m_live == 0; }
+    size_t size() const { return m_live; }
+
+    void clear() {
+        std::vector<uint8_t>().swap(m_bytes);
+        std::vector<VertexId>().swap(m_pending);
+        std::vector<uint64_t>().swap(m_dead);
+        m_count = 0;
+        m_live = 0;
+    }
+
+    void compact() {
+        if (m_pending.empty() && m_dead.empty()) {
+            return;
+        }
+        std::vector<VertexId> ids(begin(), end());
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+        clear();
+        VertexId prev = 0;
+        for (VertexId id : ids) {
+            encode(id - prev, m_bytes);
+            prev = id;
+        }
+        m_bytes.shrink_to_fit();
+        m_count = ids.size();
+        m_live = ids.size();
+    }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, m_count + m_pending.size()); }
+
+    template <class Archive>
+    void serialize(Archive& ar) { ar(m_bytes, m_pending, m_dead, m_count, m_live); }
+
+private:
+    static constexpr size_t npos = size_t(-1);
+
+    static void encode(VertexId v, std::vector<uint8_t>& out) {
+        while (v >= 0x80) {
+            out.push_back(static_cast<uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(v));
+    }
+
+    static VertexId decode(const std::vector<uint8_t>& in, size_t& offset) {
+        VertexId v = 0;
+        unsigned shift = 0;
+        uint8_t b;
+        do {
+            b = in[offset++];
+            v |= VertexId(b & 0x7F) << shift;
+            shift += 7;
+        } while (b & 0x80);
+        return v;
+    }
+
+    bool is_dead(size_t ordinal) const {
+        return ordinal / 64 < m_dead.size() && (m_dead[ordinal / 64] >> (ordinal % 64)) & 1;
+    }
+
+    // Ordinal of a live copy of id, or npos if there is none.
+    size_t find(VertexId id) const {
+        size_t offset = 0;
+        VertexId prev = 0;
+        for (size_t ordinal = 0; ordinal < m_count; ++ordinal) {
+            prev += decode(m_bytes, offset);
+            if (prev == id && !is_dead(ordinal)) {
+                return ordinal;
+            }
+            if (prev >= id) {
+                break;
+            }
+        }
+        for (size_t i = 0; i < m_pending.size(); ++i) {
+            if (m_pending[i] == id && !is_dead(m_count + i)) {
+                return m_count + i;
+            }
+        }
+        return npos;
+    }
+
+    std::vector<uint8_t> m_bytes;     // gaps of the compacted, sorted ids
+    std::vector<VertexId> m_pending;  // inserts since the last compact()
+    std::vector<uint64_t> m_dead;     // tombstones by ordinal
+    uint32_t m_count = 0;             // number of ids encoded in m_bytes
+    uint32_t m_live = 0;
+};
+
+using SetAdjacency = BasicSetAdjacency<>;
+using SortedVecAdjacency = BasicSortedVecAdjacency<>;
+using VarintAdjacency = BasicVarintAdjacency<>;
+
+using DefaultAdjacency = SortedVecAdjacency;
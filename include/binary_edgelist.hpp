@@ -0,0 +1,211 @@
+#pragma once
+#include <ygm/comm.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief On-disk layout of a binary edge list.
+ *
+ * A file is an optional 64-byte header followed by packed (src, dst) pairs
+ * of id_bytes-wide ids, exactly as they appear in the text edge list (no +1
+ * shift). Files without the header are read as raw uint32 pairs; those are
+ * recognised by the ".bel" extension.
+ *
+ * Ids and header fields are stored in host byte order, so a file is only
+ * readable on a machine with the byte order of the one that wrote it.
+ */
+struct BinaryEdgeListHeader {
+    static constexpr char kMagic[8] = {'D', 'C', 'S', 'C', 'E', 'D', 'G', 'E'};
+
+    char magic[8] = {'D', 'C', 'S', 'C', 'E', 'D', 'G', 'E'};
+    uint32_t version = 1;
+    uint32_t id_bytes = 4;       // 4 or 8
+    uint64_t num_edges = 0;
+    uint64_t num_vertices = 0;   // distinct ids, 0 if unknown
+    uint64_t min_id = 0;
+    uint64_t max_id = 0;
+    uint64_t reserved[2] = {0, 0};
+
+    bool valid() const { return std::memcmp(magic, kMagic, sizeof(kMagic)) == 0; }
+};
+static_assert(sizeof(BinaryEdgeListHeader) == 64, "header layout is part of the file format");
+
+/// True if path carries a binary edge-list header or the ".bel" extension.
+inline bool is_binary_edgelist(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    BinaryEdgeListHeader header;
+    if (in.read(reinterpret_cast<char*>(&header), sizeof(header)) && header.valid()) {
+        return true;
+    }
+    return path.size() >= 4 && path.compare(path.size() - 4, 4, ".bel") == 0;
+}
+
+namespace detail {
+
+template <typename Id, typename Function>
+inline void for_each_binary_record(const char* records, uint64_t first, uint64_t last, Function& fn) {
+    constexpr size_t kRecord = 2 * sizeof(Id);
+    for (uint64_t i = first; i < last; ++i) {
+        Id src, dst;
+        std::memcpy(&src, records + i * kRecord, sizeof(Id));
+        std::memcpy(&dst, records + i * kRecord + sizeof(Id), sizeof(Id));
+        fn(src, dst);
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief Call fn(src, dst) for this rank's share of a binary edge list.
+ *
+ * The file is memory-mapped read-only and split into P contiguous record
+ * ranges; each rank touches only its own range, so no text is parsed and no
+ * bytes are read twice. Ids are passed as read (uint64_t for 8-byte files).
+ */
+template <typename Function>
+inline void for_all_binary_edges(ygm::comm &world, const std::string& path, Function fn) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open binary edge list " + path);
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("cannot stat binary edge list " + path);
+    }
+    const uint64_t file_size = st.st_size;
+
+    BinaryEdgeListHeader header;
+    uint64_t data_offset = 0;
+    if (file_size >= sizeof(header) && ::pread(fd, &header, sizeof(header), 0) == sizeof(header) && header.valid()) {
+        data_offset = sizeof(header);
+    } else {
+        header = BinaryEdgeListHeader();
+    }
+
+    if (header.id_bytes != 4 && header.id_bytes != 8) {
+        ::close(fd);
+        throw std::runtime_error("unsupported id width in " + path);
+    }
+
+    const uint64_t record = 2 * header.id_bytes;
+    const uint64_t num_records = (file_size - data_offset) / record;
+    const uint64_t first = num_records * world.rank() / world.size();
+    const uint64_t last = num_records * (world.rank() + 1) / world.size();
+
+    if (first < last) {
+        // mmap offsets must be page aligned; map from the page holding the first record.
+        const uint64_t begin = data_offset + first * record;
+        const uint64_t end = data_offset + last * record;
+        const uint64_t page = ::sysconf(_SC_PAGESIZE);
+        const uint64_t map_begin = begin - begin % page;
+
+        void* base = ::mmap(nullptr, end - map_begin, PROT_READ, MAP_PRIVATE, fd, map_begin);
+        if (base == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("cannot mmap binary edge list " + path);
+        }
+        ::madvise(base, end - map_begin, MADV_SEQUENTIAL);
+
+        const char* records = static_cast<const char*>(base) + (begin - map_begin);
+        if (header.id_bytes == 4) {
+            detail::for_each_binary_record<uint32_t>(records, 0, last - first, fn);
+        } else {
+            detail::for_each_binary_record<uint64_t>(records, 0, last - first, fn);
+        }
+
+        ::munmap(base, end - map_begin);
+    }
+
+    ::close(fd);
+}
+
+/**
+ * @brief Collectively write edges to a binary edge list.
+ *
+ * Every rank passes the edges it holds; rank r's edges are written after
+ * those of ranks 0..r-1 with pwrite, so the file is produced in parallel
+ * without a gather. header.num_edges is filled in here.
+ */
+template <typename Id>
+inline void write_binary_edgelist(ygm::comm &world, const std::string& path,
+                                  const std::vector<std::pair<Id, Id>>& edges, BinaryEdgeListHeader header) {
+    static_assert(sizeof(Id) == 4 || sizeof(Id) == 8, "ids are 4 or 8 bytes");
+    header.id_bytes = sizeof(Id);
+
+    std::vector<uint64_t> counts(world.size(), 0);
+    counts[world.rank()] = edges.size();
+    counts = world.all_reduce(counts, [](const std::vector<uint64_t>& a, const std::vector<uint64_t>& b) {
+        std::vector<uint64_t> sum(a);
+        for (size_t i = 0; i < sum.size(); ++i) {
+            sum[i] += b[i];
+        }
+        return sum;
+    });
+
+    uint64_t before = 0;
+    header.num_edges = 0;
+    for (int r = 0; r < world.size(); ++r) {
+        if (r < world.rank()) {
+            before += counts[r];
+        }
+        header.num_edges += counts[r];
+    }
+
+    const uint64_t record = 2 * sizeof(Id);
+    if (world.rank0()) {
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("cannot create binary edge list " + path);
+        }
+        bool ok = ::pwrite(fd, &header, sizeof(header), 0) == sizeof(header) &&
+                  ::ftruncate(fd, sizeof(header) + header.num_edges * record) == 0;
+        ::close(fd);
+        if (!ok) {
+            throw std::runtime_error("cannot write header of binary edge list " + path);
+        }
+    }
+    world.barrier();
+
+    int fd = ::open(path.c_str(), O_WRONLY);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open binary edge list " + path);
+    }
+
+    std::vector<Id> buffer;
+    buffer.reserve(2 * edges.size());
+    for (const auto& [src, dst] : edges) {
+        buffer.push_back(src);
+        buffer.push_back(dst);
+    }
+
+    const char* bytes = reinterpret_cast<const char*>(buffer.data());
+    uint64_t remaining = buffer.size() * sizeof(Id);
+    uint64_t offset = sizeof(header) + before * record;
+    while (remaining > 0) {
+        ssize_t written = ::pwrite(fd, bytes, remaining, offset);
+        if (written <= 0) {
+            ::close(fd);
+            throw std::runtime_error("short write to binary edge list " + path);
+        }
+        bytes += written;
+        offset += written;
+        remaining -= written;
+    }
+
+    ::close(fd);
+    world.barrier();
+}
@@ -0,0 +1,186 @@
+#pragma once
+#include <ygm/comm.hpp>
+#include <ygm/container/map.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/string.hpp>
+
+#include "compaction.hpp"
+#include "csr_graph.hpp"
+#include "graph_util.hpp"
+
+/**
+ * @brief Per-rank snapshots of the DCSC vertex state.
+ *
+ * A snapshot is a directory holding one binary file per rank
+ * (rank-<r>.ckpt: a CheckpointHeader followed by that rank's vertices) and a
+ * COMPLETE marker that rank 0 writes once every rank has finished. The
+ * checkpoint directory itself holds the iteration-0 snapshot (the graph
+ * right after construction), the most recent one, and a LATEST file naming
+ * it. Vertices are stored on the rank that owns them, so a snapshot can
+ * only be restored with the same number of ranks and the same graph layout.
+ */
+struct CheckpointHeader {
+    static constexpr uint64_t kMagic = 0x54504B4343534344;   // "DCSCCKPT"
+    static constexpr uint32_t kVersion = 3;   // 2: 32-bit comp_id, packed vertex flags; 3: CSR input ids
+
+    uint64_t magic = kMagic;
+    uint32_t version = kVersion;
+    uint32_t nranks = 0;
+    std::string layout;          // "map/<adjacency>", "map64/<adjacency>" or "csr"
+    uint64_t iteration = 0;      // next DCSC iteration to run
+    uint64_t unterminated = 1;   // active vertices left when the snapshot was taken
+
+    template <class Archive>
+    void serialize(Archive& ar) { ar(magic, version, nranks, layout, iteration, unterminated); }
+};
+
+namespace detail {
+
+inline std::string snapshot_name(uint64_t iteration) { return "iter-" + std::to_string(iteration); }
+
+inline std::filesystem::path rank_snapshot_file(const std::filesystem::path& snapshot, int rank) {
+    return snapshot / ("rank-" + std::to_string(rank) + ".ckpt");
+}
+
+// compacted vertices are written as the inactive, edgeless vertices restore_compacted would make of them
+template <typename VertexId, typename Info>
+inline void save_vertices(cereal::BinaryOutputArchive& ar, ygm::container::map<VertexId, Info>& vertex_map,
+                          const BasicCompactedVertices<VertexId>* compacted) {
+    uint64_t count = vertex_map.local_size() + (compacted ? compacted->labels.size() : 0);
+    ar(count);
+    vertex_map.local_for_all([&ar](const VertexId& vtx, Info& info) {
+        ar(vtx, info);
+    });
+    if (compacted) {
+        for (const auto& [vtx, comp] : compacted->labels) {
+            Info info;
+            info.comp_id = comp;
+            info.active = false;
+            ar(vtx, info);
+        }
+    }
+}
+
+inline void save_vertices(cereal::BinaryOutputArchive& ar, CsrGraph& graph, const BasicCompactedVertices<uint32_t>*) { ar(graph); }
+
+template <typename VertexId, typename Info>
+inline void load_vertices(cereal::BinaryInputArchive& ar, ygm::container::map<VertexId, Info>& vertex_map) {
+    uint64_t count;
+    ar(count);
+    for (uint64_t i = 0; i < count; ++i) {
+        VertexId vtx;
+        Info saved;
+        ar(vtx, saved);
+
+        auto restore = [&saved](const VertexId& vtx, Info& info) { info = std::move(saved); };
+        vertex_map.local_visit(vtx, restore);
+    }
+}
+
+inline void load_vertices(cereal::BinaryInputArchive& ar, CsrGraph& graph) { ar(graph); }
+
+} // namespace detail
+
+/**
+ * @brief Collectively write a snapshot of graph into dir/iter-<header.iteration>.
+ *
+ * Once it is complete, LATEST is pointed at it and the previous intermediate
+ * snapshot is removed; the iteration-0 snapshot is always kept. The vertices
+ * a map graph has compacted out are saved along with it, so the snapshot
+ * holds every vertex while the run keeps them compacted; a restored graph
+ * has them back in the map.
+ */
+template <typename Graph>
+inline void save_checkpoint(ygm::comm &world, const std::string& dir, CheckpointHeader header, Graph& graph,
+                            const BasicCompactedVertices<vertex_id_t<Graph>>* compacted = nullptr) {
+    namespace fs = std::filesystem;
+    const fs::path snapshot = fs::path(dir) / detail::snapshot_name(header.iteration);
+
+    if (world.rank0()) {
+        fs::remove_all(snapshot);
+        fs::create_directories(snapshot);
+    }
+    world.barrier();
+
+    header.nranks = world.size();
+    {
+        std::ofstream out(detail::rank_snapshot_file(snapshot, world.rank()), std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("cannot create checkpoint in " + snapshot.string());
+        }
+        cereal::BinaryOutputArchive ar(out);
+        ar(header);
+        detail::save_vertices(ar, graph, compacted);
+        out.flush();
+        if (!out) {
+            throw std::runtime_error("short write to checkpoint in " + snapshot.string());
+        }
+    }
+    world.barrier();
+
+    if (world.rank0()) {
+        std::ofstream(snapshot / "COMPLETE") << header.iteration << std::endl;
+
+        std::string previous;
+        std::ifstream(fs::path(dir) / "LATEST") >> previous;
+        std::ofstream(fs::path(dir) / "LATEST.tmp") << snapshot.filename().string() << std::endl;
+        fs::rename(fs::path(dir) / "LATEST.tmp", fs::path(dir) / "LATEST");
+
+        if (!previous.empty() && previous != detail::snapshot_name(0) && previous != snapshot.filename().string()) {
+            fs::remove_all(fs::path(dir) / previous);
+        }
+    }
+    world.barrier();
+}
+
+/**
+ * @brief Collectively restore graph from a snapshot and return its header.
+ *
+ * path is either a snapshot directory or a checkpoint directory, in which
+ * case the snapshot named by its LATEST file is used. graph must be empty.
+ */
+template <typename Graph>
+inline CheckpointHeader load_checkpoint(ygm::comm &world, const std::string& path, const std::string& layout, Graph& graph) {
+    namespace fs = std::filesystem;
+    fs::path snapshot = path;
+
+    std::string latest;
+    if (std::ifstream(snapshot / "LATEST") >> latest) {
+        snapshot /= latest;
+    }
+    if (!fs::exists(snapshot / "COMPLETE")) {
+        throw std::runtime_error("no complete checkpoint at " + snapshot.string());
+    }
+
+    std::ifstream in(detail::rank_snapshot_file(snapshot, world.rank()), std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("checkpoint " + snapshot.string() + " has no file for rank " + std::to_string(world.rank()));
+    }
+
+    cereal::BinaryInputArchive ar(in);
+    CheckpointHeader header;
+    ar(header);
+
+    if (header.magic != CheckpointHeader::kMagic || header.version != CheckpointHeader::kVersion) {
+        throw std::runtime_error("not a DCSC checkpoint: " + snapshot.string());
+    }
+    if (header.nranks != uint32_t(world.size())) {
+        throw std::runtime_error("checkpoint was written by " + std::to_string(header.nranks) + " ranks, running on " +
+                                 std::to_string(world.size()));
+    }
+    if (header.layout != layout) {
+        throw std::runtime_error("checkpoint holds a '" + header.layout + "' graph, not '" + layout + "'");
+    }
+
+    detail::load_vertices(ar, graph);
+    world.barrier();
+
+    return header;
+}
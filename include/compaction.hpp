@@ -0,0 +1,84 @@
+#pragma once
+#include <ygm/comm.hpp>
+#include <ygm/container/map.hpp>
+#include <ygm/detail/collective.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "graph_util.hpp"
+
+/**
+ * @brief Terminated vertices taken out of the working vertex map between iterations.
+ *
+ * Once a vertex has its final SCC no kernel sends to it again: trim and
+ * shear have deleted every edge that joins it to a vertex still active. Its
+ * map entry only makes every local_for_all longer. compact_terminated()
+ * therefore moves the (vertex, comp_id) pair of each inactive local vertex
+ * into this rank's sorted array and erases the entry, and
+ * restore_compacted() puts them back as inactive vertices without edges, so
+ * everything that reads the labels after the run sees the whole graph.
+ *
+ * Vertices stay on the rank that owns them: the map's hash partitioner
+ * decides ownership, so the survivors are as balanced as the hash makes
+ * them.
+ */
+template <typename VertexId>
+struct BasicCompactedVertices {
+    std::vector<std::pair<VertexId, VertexId>> labels;   // (vertex, comp_id), sorted by vertex
+
+    bool compacted(VertexId vtx) const {
+        auto it = std::lower_bound(labels.begin(), labels.end(), std::make_pair(vtx, VertexId(0)));
+        return it != labels.end() && it->first == vtx;
+    }
+};
+
+/**
+ * @brief Collectively move every terminated local vertex of vertex_map into compacted.
+ *
+ * Entries of work that were compacted are dropped, since trimming them would
+ * recreate them. Returns the number of vertices left in the map.
+ */
+template <typename VertexId, typename Info>
+inline size_t compact_terminated(ygm::comm& world, ygm::container::map<VertexId, Info>& vertex_map,
+                                 BasicCompactedVertices<VertexId>& compacted, BasicTrimWorklist<VertexId>* work = nullptr) {
+    std::vector<std::pair<VertexId, VertexId>> retired;
+    vertex_map.local_for_all([&retired](const VertexId& vtx, const Info& info) {
+        if (!info.active) {
+            retired.emplace_back(vtx, info.comp_id);
+        }
+    });
+    for (const auto& [vtx, comp] : retired) {
+        vertex_map.local_erase(vtx);
+    }
+
+    std::sort(retired.begin(), retired.end());
+    size_t merged = compacted.labels.size();
+    compacted.labels.insert(compacted.labels.end(), retired.begin(), retired.end());
+    std::inplace_merge(compacted.labels.begin(), compacted.labels.begin() + merged, compacted.labels.end());
+
+    if (work) {
+        auto& vertices = work->vertices;
+        vertices.erase(std::remove_if(vertices.begin(), vertices.end(),
+                                      [&compacted](VertexId vtx) { return compacted.compacted(vtx); }),
+                       vertices.end());
+    }
+
+    return ygm::sum(vertex_map.local_size(), world);
+}
+
+/// Put every compacted vertex back into vertex_map as an inactive vertex with its comp_id, and empty compacted.
+template <typename VertexId, typename Info>
+inline void restore_compacted(ygm::comm& world, ygm::container::map<VertexId, Info>& vertex_map,
+                              BasicCompactedVertices<VertexId>& compacted) {
+    for (const auto& [vtx, comp] : compacted.labels) {
+        vertex_map.local_visit(vtx, [](const VertexId& vtx, Info& info, VertexId comp) {
+            info.comp_id = comp;
+            info.active = false;
+        }, comp);
+    }
+    std::vector<std::pair<VertexId, VertexId>>().swap(compacted.labels);
+
+    world.barrier();
+}
@@ -0,0 +1,191 @@
+#pragma once
+#include <ygm/comm.hpp>
+#include <ygm/container/map.hpp>
+#include <ygm/detail/collective.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "binary_edgelist.hpp"
+#include "csr_graph.hpp"
+#include "graph_util.hpp"
+#include "phase_stats.hpp"
+#include "scc_output.hpp"
+
+/**
+ * @brief Condensation DAG of a converged graph: one vertex per SCC, one edge per pair of SCCs joined by an edge.
+ *
+ * DCSC deletes every edge between two SCCs as it goes (trim and shear), so
+ * when it converges the neighbor lists only hold edges inside an SCC. The
+ * cross edges are therefore taken from the edge source again: each rank
+ * streams its own share, an edge (u, v) visits u's owner to pick up u's
+ * comp_id and then v's owner, which keeps it as (comp(u), comp(v)) if the
+ * two differ. Vertices are never reloaded.
+ *
+ * The kept pairs are deduplicated locally and then built into the DAG like
+ * any other graph: the edge batcher hashes each pair to the owner of its
+ * endpoints, where sorting removes the remaining duplicates. The DAG has the
+ * graph's container type, its vertices are the SCC labels, and every SCC
+ * shows up even if it has no cross edge, since its label is added as a
+ * self-loop (dropped, vertex kept).
+ */
+
+namespace detail {
+
+/// comp_id of a vertex this rank owns.
+template <typename VertexId, typename Info>
+inline VertexId local_component(ygm::container::map<VertexId, Info>& vertex_map, VertexId vtx) {
+    VertexId comp = -1;
+    vertex_map.local_visit(vtx, [&comp](const VertexId& vtx, Info& info) { comp = info.comp_id; });
+    return comp;
+}
+
+inline uint32_t local_component(CsrGraph& graph, uint32_t vtx) { return graph.comp_id[graph.local_index(vtx)]; }
+
+template <typename VertexId, typename Info, typename EdgeSource>
+inline void create_graph_from_edges(ygm::comm& world, EdgeSource&& for_each_edge, ygm::container::map<VertexId, Info>& graph,
+                                    size_t batch_size) {
+    create_vertex_map_from_edges(world, for_each_edge, graph, batch_size);
+}
+
+template <typename EdgeSource>
+inline void create_graph_from_edges(ygm::comm& world, EdgeSource&& for_each_edge, CsrGraph& graph, size_t batch_size) {
+    create_csr_graph_from_edges(world, for_each_edge, graph, batch_size);
+}
+
+/// fn(src, dst) for every live edge leaving a local vertex.
+template <typename VertexId, typename Info, typename Function>
+inline void for_all_local_edges(ygm::container::map<VertexId, Info>& vertex_map, Function fn) {
+    vertex_map.local_for_all([&fn](const VertexId& vtx, const Info& info) {
+        for (auto nbr : info.out) {
+            fn(vtx, nbr);
+        }
+    });
+}
+
+template <typename Function>
+inline void for_all_local_edges(CsrGraph& graph, Function fn) {
+    for (uint32_t l = 0; l < graph.num_local(); ++l) {
+        graph.for_each_out(l, [&fn, vtx = graph.global_id(l)](uint32_t nbr) { fn(vtx, nbr); });
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief Collectively relabel a stream of edges with their endpoints' comp_ids.
+ *
+ * for_each_edge(fn) calls fn(src, dst) for this rank's share of the edges;
+ * every endpoint must be a vertex of graph. Returns this rank's share of the
+ * (comp(src), comp(dst)) pairs whose labels differ, sorted and unique.
+ */
+template <typename Graph, typename EdgeSource>
+inline std::vector<std::pair<vertex_id_t<Graph>, vertex_id_t<Graph>>> cross_component_edges(ygm::comm& world, Graph& graph,
+                                                                                            EdgeSource&& for_each_edge) {
+    using vertex_type = vertex_id_t<Graph>;
+
+    static Graph* p_graph;
+    static ygm::comm* p_world;
+    static std::vector<std::pair<vertex_type, vertex_type>>* p_cross;
+    std::vector<std::pair<vertex_type, vertex_type>> cross;
+    p_graph = &graph;
+    p_world = &world;
+    p_cross = &cross;
+
+    struct at_target {
+        void operator()(vertex_type dst, vertex_type src_comp) const {
+            vertex_type dst_comp = detail::local_component(*p_graph, dst);
+            if (src_comp != dst_comp) {
+                p_cross->emplace_back(src_comp, dst_comp);
+            }
+        }
+    };
+
+    struct at_source {
+        void operator()(vertex_type src, vertex_type dst) const {
+            vertex_type src_comp = detail::local_component(*p_graph, src);
+            int owner = detail::vertex_owner(*p_graph, dst);
+            if (owner == p_world->rank()) {
+                at_target()(dst, src_comp);
+            } else {
+                p_world->async(owner, at_target(), dst, src_comp);
+                count_message(dst, src_comp);
+            }
+        }
+    };
+
+    for_each_edge([&world, &graph](vertex_type src, vertex_type dst) {
+        if (src == dst) {
+            return;
+        }
+        int owner = detail::vertex_owner(graph, src);
+        if (owner == world.rank()) {
+            at_source()(src, dst);
+        } else {
+            world.async(owner, at_source(), src, dst);
+            count_message(src, dst);
+        }
+    });
+    timed_barrier(world);
+
+    std::sort(cross.begin(), cross.end());
+    cross.erase(std::unique(cross.begin(), cross.end()), cross.end());
+    return cross;
+}
+
+/**
+ * @brief Collectively build the condensation DAG of graph into the empty dag.
+ *
+ * for_each_edge(fn) must call fn(src, dst) for this rank's share of the
+ * edges graph was built from, with the same ids.
+ */
+template <typename Graph, typename EdgeSource>
+inline void build_condensation(ygm::comm& world, Graph& graph, EdgeSource&& for_each_edge, Graph& dag,
+                               size_t batch_size = kDefaultEdgeBatch) {
+    using vertex_type = vertex_id_t<Graph>;
+
+    std::vector<std::pair<vertex_type, vertex_type>> cross = cross_component_edges(world, graph, for_each_edge);
+
+    std::vector<vertex_type> labels;
+    detail::for_all_local_components(graph, [&labels](vertex_type vtx, vertex_type comp) {
+        if (comp == vtx) {
+            labels.push_back(comp);
+        }
+    });
+
+    detail::create_graph_from_edges(world, [&cross, &labels](auto fn) {
+        for (const auto& [src, dst] : cross) {
+            fn(src, dst);
+        }
+        for (vertex_type label : labels) {
+            fn(label, label);
+        }
+    }, dag, batch_size);
+}
+
+/// Collectively write the edges of a condensation DAG to a binary edge list at path, in input ids. Returns the edge count.
+template <typename Graph>
+inline uint64_t write_condensation(ygm::comm& world, Graph& dag, const std::string& path) {
+    using vertex_type = vertex_id_t<Graph>;
+
+    std::vector<std::pair<vertex_type, vertex_type>> edges;
+    vertex_type min_id = -1;
+    vertex_type max_id = 0;
+    uint64_t vertices = 0;
+    detail::for_all_local_components(dag, [&](vertex_type vtx, vertex_type comp) {
+        min_id = std::min(min_id, vertex_type(vtx - 1));
+        max_id = std::max(max_id, vertex_type(vtx - 1));
+        ++vertices;
+    });
+    detail::for_all_local_edges(dag, [&edges](vertex_type src, vertex_type dst) { edges.emplace_back(src - 1, dst - 1); });
+
+    BinaryEdgeListHeader header;
+    header.num_vertices = ygm::sum(vertices, world);
+    header.min_id = header.num_vertices ? ygm::min(min_id, world) : 0;
+    header.max_id = ygm::max(max_id, world);
+    write_binary_edgelist(world, path, edges, header);
+
+    return ygm::sum(uint64_t(edges.size()), world);
+}
@@ -0,0 +1,369 @@
+#pragma once
+#include <ygm/comm.hpp>
+#include <ygm/container/map.hpp>
+#include <ygm/detail/collective.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "graph_util.hpp"
+#include "hub_mirrors.hpp"
+
+/**
+ * @brief Rank-local CSR partition of a directed graph with struct-of-arrays vertex state.
+ *
+ * Vertices are dealt out cyclically: vertex v lives on rank v % P at local
+ * index v / P. Both directions are computed arithmetically, so a message to
+ * a neighbor carries its local index and is applied with a plain array
+ * access instead of a hash lookup. Ids that never appear in the edge list
+ * leave holes that are marked not present (and inactive).
+ *
+ * The layout is dense: a rank holds a slot for every local index up to its
+ * largest, so ids have to cover their range densely. finalize() rejects ids
+ * spread so thinly that the holes would dominate the vertex state (relabel
+ * them with the LDG stage, or use the vertex map), as well as local indices
+ * past 32 bits.
+ *
+ * Neighbor lists hold global ids, sorted and unique per vertex. Edges
+ * removed by trim/shear are tombstoned in a bitmap and the live degree is
+ * tracked per vertex, so no CSR array is ever rewritten after finalize().
+ *
+ * mirror_hubs() optionally replicates the high-degree vertices on every
+ * rank (see HubMirrors); the phases fall back to plain edge walks for
+ * everything that is not a hub.
+ */
+class CsrGraph {
+public:
+    explicit CsrGraph(ygm::comm& world)
+        : m_world(world), m_rank(world.rank()), m_nranks(world.size()) {}
+
+    ygm::comm& comm() { return m_world; }
+
+    int owner(uint32_t vtx) const { return vtx % m_nranks; }
+    uint32_t local_index(uint32_t vtx) const { return vtx / m_nranks; }
+    uint32_t global_id(uint32_t lidx) const { return lidx * m_nranks + m_rank; }
+
+    /// Number of local slots, holes included.
+    uint32_t num_local() const { return present.size(); }
+
+    /// Construction: buffer an edge whose source (resp. target) this rank owns.
+    void local_add_out(uint32_t src, uint32_t dst) { m_out_pairs.emplace_back(local_index(src), dst); }
+    void local_add_in(uint32_t dst, uint32_t src) { m_in_pairs.emplace_back(local_index(dst), src); }
+    /// Construction: mark an owned vertex present even if it ends up with no edges.
+    void local_add_vertex(uint32_t vtx) { m_vertices.push_back(local_index(vtx)); }
+
+    /// Most local slots finalize() allocates per buffered edge endpoint or vertex, beyond kMinSlots.
+    static constexpr uint64_t kMaxSlotsPerEntry = 16;
+    static constexpr uint64_t kMinSlots = uint64_t(1) << 20;
+
+    /**
+     * @brief Build the CSR arrays from the buffered edges and reset the vertex state. Collective.
+     *
+     * Throws std::overflow_error on every rank if a local index does not fit
+     * 32 bits, and std::length_error if the ids are too sparse for the
+     * dense layout, before anything is allocated.
+     */
+    void finalize() {
+        // counted in 64 bits: the local index UINT32_MAX would wrap a 32-bit count to 0
+        uint64_t n = 0;
+        for (const auto& [l, nbr] : m_out_pairs) n = std::max<uint64_t>(n, uint64_t(l) + 1);
+        for (const auto& [l, nbr] : m_in_pairs) n = std::max<uint64_t>(n, uint64_t(l) + 1);
+        for (uint32_t l : m_vertices) n = std::max<uint64_t>(n, uint64_t(l) + 1);
+
+        // every present vertex has at least one entry, so this bounds the holes without counting vertices
+        uint64_t entries = m_out_pairs.size() + m_in_pairs.size() + m_vertices.size();
+        uint64_t slots = ygm::max(n, m_world);
+        if (ygm::logical_or(n > std::numeric_limits<uint32_t>::max(), m_world)) {
+            throw std::overflow_error("--graph csr holds at most 2^32 - 1 vertices per rank, but a rank would need " +
+                                      std::to_string(slots) + " slots");
+        }
+        if (ygm::logical_or(n > kMaxSlotsPerEntry * entries + kMinSlots, m_world)) {
+            throw std::length_error("vertex ids are too sparse for --graph csr, which would allocate up to " +
+                                    std::to_string(slots) + " slots per rank; relabel them with --partition ldg"
+                                    " or use --graph map");
+        }
+
+        present.assign(n, 0);
+        for (const auto& [l, nbr] : m_out_pairs) present[l] = 1;
+        for (const auto& [l, nbr] : m_in_pairs) present[l] = 1;
+        for (uint32_t l : m_vertices) present[l] = 1;
+        std::vector<uint32_t>().swap(m_vertices);
+
+        m_out.build(m_out_pairs, uint32_t(n));
+        m_in.build(m_in_pairs, uint32_t(n));
+
+        active.assign(present.begin(), present.end());
+        mark_pred.assign(n, 0);
+        mark_desc.assign(n, 0);
+        is_pivot.assign(n, 0);
+        comp_id.assign(n, uint32_t(-1));
+        wcc_pivot.assign(n, uint32_t(-1));
+    }
+
+    template <typename Function>
+    void for_each_out(uint32_t lidx, Function fn) const { m_out.for_each(lidx, fn); }
+    template <typename Function>
+    void for_each_in(uint32_t lidx, Function fn) const { m_in.for_each(lidx, fn); }
+
+    /// Whether pred(nbr) holds for some live out- (in-) neighbor; stops at the first one.
+    template <typename Predicate>
+    bool any_out(uint32_t lidx, Predicate pred) const { return m_out.any(lidx, pred); }
+    template <typename Predicate>
+    bool any_in(uint32_t lidx, Predicate pred) const { return m_in.any(lidx, pred); }
+
+    uint32_t out_degree(uint32_t lidx) const { return m_out.degree[lidx]; }
+    uint32_t in_degree(uint32_t lidx) const { return m_in.degree[lidx]; }
+
+    bool has_out(uint32_t lidx, uint32_t nbr) const { return m_out.contains(lidx, nbr); }
+    bool has_in(uint32_t lidx, uint32_t nbr) const { return m_in.contains(lidx, nbr); }
+
+    void erase_out(uint32_t lidx, uint32_t nbr) { m_out.erase(lidx, nbr); }
+    void erase_in(uint32_t lidx, uint32_t nbr) { m_in.erase(lidx, nbr); }
+    void clear_out(uint32_t lidx) { m_out.clear(lidx); }
+    void clear_in(uint32_t lidx) { m_in.clear(lidx); }
+
+    /// Mirror the vertices with in + out degree >= min_degree on every rank; 0 turns mirroring off. Collective.
+    void mirror_hubs(uint32_t min_degree) { hubs.build(m_world, *this, min_degree); }
+
+    // Vertex state, indexed by local index.
+    std::vector<uint8_t> present;
+    std::vector<uint8_t> active;
+    std::vector<uint8_t> mark_pred;
+    std::vector<uint8_t> mark_desc;
+    std::vector<uint8_t> is_pivot;
+    std::vector<uint32_t> comp_id;   // pivot marker while active, as in BasicVtxInfo
+    std::vector<uint32_t> wcc_pivot;
+
+    /// Input id (shifted up by one) of every local slot when the graph was built from relabeled edges, else empty.
+    std::vector<uint32_t> input_ids;
+
+    /// Not part of a checkpoint; mirror_hubs() again after restoring one.
+    HubMirrors hubs;
+
+    /// Finalized graph and vertex state, for checkpoints; the owning comm is not part of it.
+    template <class Archive>
+    void serialize(Archive& ar) {
+        ar(m_out, m_in, present, active, mark_pred, mark_desc, is_pivot, comp_id, wcc_pivot, input_ids);
+    }
+
+private:
+    struct Edges {
+        std::vector<uint64_t> offsets;   // n + 1 entries
+        std::vector<uint32_t> targets;   // global ids, sorted within a vertex
+        std::vector<uint64_t> dead;      // tombstone bit per edge
+        std::vector<uint32_t> degree;    // live edges per vertex
+
+        template <class Archive>
+        void serialize(Archive& ar) { ar(offsets, targets, dead, degree); }
+
+        void build(std::vector<std::pair<uint32_t, uint32_t>>& pairs, uint32_t n) {
+            std::sort(pairs.begin(), pairs.end());
+            pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+            offsets.assign(n + 1, 0);
+            degree.assign(n, 0);
+            for (const auto& [l, nbr] : pairs) {
+                ++degree[l];
+            }
+            for (uint32_t l = 0; l < n; ++l) {
+                offsets[l + 1] = offsets[l] + degree[l];
+            }
+
+            targets.resize(pairs.size());
+            for (size_t e = 0; e < pairs.size(); ++e) {
+                targets[e] = pairs[e].second;
+            }
+            dead.assign((targets.size() + 63) / 64, 0);
+
+            std::vector<std::pair<uint32_t, uint32_t>>().swap(pairs);
+        }
+
+        bool is_dead(uint64_t e) const { return (dead[e / 64] >> (e % 64)) & 1; }
+        void kill(uint64_t e) { dead[e / 64] |= uint64_t(1) << (e % 64); }
+
+        template <typename Function>
+        void for_each(uint32_t l, Function& fn) const {
+            if (degree[l] == 0) {
+                return;
+            }
+            for (uint64_t e = offsets[l]; e < offsets[l + 1]; ++e) {
+                if (!is_dead(e)) {
+                    fn(targets[e]);
+                }
+            }
+        }
+
+        template <typename Predicate>
+        bool any(uint32_t l, Predicate& pred) const {
+            if (degree[l] == 0) {
+                return false;
+            }
+            for (uint64_t e = offsets[l]; e < offsets[l + 1]; ++e) {
+                if (!is_dead(e) && pred(targets[e])) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Position of nbr in l's list, or targets.size() if absent.
+        uint64_t find(uint32_t l, uint32_t nbr) const {
+            auto first = targets.begin() + offsets[l];
+            auto last = targets.begin() + offsets[l + 1];
+            auto it = std::lower_bound(first, last, nbr);
+            return it != last && *it == nbr ? uint64_t(it - targets.begin()) : targets.size();
+        }
+
+        bool contains(uint32_t l, uint32_t nbr) const {
+            uint64_t e = find(l, nbr);
+            return e != targets.size() && !is_dead(e);
+        }
+
+        void erase(uint32_t l, uint32_t nbr) {
+            uint64_t e = find(l, nbr);
+            if (e != targets.size() && !is_dead(e)) {
+                kill(e);
+                --degree[l];
+            }
+        }
+
+        void clear(uint32_t l) {
+            for (uint64_t e = offsets[l]; e < offsets[l + 1]; ++e) {
+                kill(e);
+            }
+            degree[l] = 0;
+        }
+    };
+
+    ygm::comm& m_world;
+    int m_rank;
+    int m_nranks;
+
+    std::vector<std::pair<uint32_t, uint32_t>> m_out_pairs;
+    std::vector<std::pair<uint32_t, uint32_t>> m_in_pairs;
+    std::vector<uint32_t> m_vertices;
+
+    Edges m_out;
+    Edges m_in;
+};
+
+/// CsrGraph ids are 32-bit.
+template <>
+struct vertex_id<CsrGraph> {
+    using type = uint32_t;
+};
+
+/**
+ * @brief Build a CsrGraph from an edge source: for_each_edge(fn) calls fn(src, dst) for this rank's share of the edges.
+ *
+ * batch_size selects packed, deduplicated batches (self-loops dropped, their
+ * vertex kept) or, when 0, one message per edge endpoint; see EdgeBatcher.
+ */
+template <typename EdgeSource>
+inline void create_csr_graph_from_edges(ygm::comm &world, EdgeSource&& for_each_edge, CsrGraph& graph,
+                                        size_t batch_size = kDefaultEdgeBatch) {
+    static CsrGraph* p_graph;
+    p_graph = &graph;
+
+    if (batch_size > 0) {
+        EdgeBatcher batcher(world, batch_size);
+        for_each_edge([&batcher, &graph](uint32_t src, uint32_t dst) {
+            batcher.add(src, dst, graph.owner(src), graph.owner(dst));
+        });
+        batcher.finish();
+
+        for (const auto& [src, dst] : batcher.out_edges()) {
+            graph.local_add_out(src, dst);
+        }
+        for (const auto& [dst, src] : batcher.in_edges()) {
+            graph.local_add_in(dst, src);
+        }
+        for (uint32_t vtx : batcher.loop_vertices()) {
+            graph.local_add_vertex(vtx);
+        }
+    } else {
+        for_each_edge([&world, &graph](uint32_t src, uint32_t dst) {
+            auto add_fwd_edge = [](uint32_t src, uint32_t dst) {
+                p_graph->local_add_out(src, dst);
+            };
+
+            auto add_reverse_edge = [](uint32_t dst, uint32_t src) {
+                p_graph->local_add_in(dst, src);
+            };
+
+            world.async(graph.owner(src), add_fwd_edge, src, dst);
+            world.async(graph.owner(dst), add_reverse_edge, dst, src);
+        });
+
+        world.barrier();
+    }
+
+    graph.finalize();
+}
+
+inline void create_csr_graph(ygm::comm &world, const std::string& edgelist_file, CsrGraph& graph,
+                             size_t batch_size = kDefaultEdgeBatch) {
+    if (world.rank0()) {
+        std::cout << "Reading edges from " << edgelist_file << std::endl;
+    }
+
+    create_csr_graph_from_edges(world, [&](auto fn) { for_all_edges(world, edgelist_file, fn); }, graph, batch_size);
+}
+
+inline void find_vertex_range(ygm::comm& world, CsrGraph& graph, uint32_t& min_vtx, uint32_t& max_vtx) {
+    max_vtx = 0;
+    min_vtx = -1;
+
+    for (uint32_t l = 0; l < graph.num_local(); ++l) {
+        if (graph.present[l]) {
+            max_vtx = std::max(max_vtx, graph.global_id(l));
+            min_vtx = std::min(min_vtx, graph.global_id(l));
+        }
+    }
+
+    max_vtx = ygm::max(max_vtx, world);
+    min_vtx = ygm::min(min_vtx, world);
+}
+
+inline size_t local_active_count(CsrGraph& graph) {
+    return std::count(graph.active.begin(), graph.active.end(), 1);
+}
+
+inline uint32_t count_sccs(ygm::comm& world, CsrGraph& graph) {
+
+    uint32_t local_count = 0;
+
+    for (uint32_t l = 0; l < graph.num_local(); ++l) {
+        if (graph.present[l] && graph.comp_id[l] == graph.global_id(l)) {
+            local_count++;
+        }
+    }
+
+    return ygm::sum(local_count, world);
+}
+
+inline uint32_t count_largest_scc(ygm::comm& world, CsrGraph& graph) {
+
+    ygm::container::map<uint32_t, uint32_t> scc_sizes(world);
+
+    for (uint32_t l = 0; l < graph.num_local(); ++l) {
+        if (graph.present[l]) {
+            scc_sizes.async_visit(graph.comp_id[l], [](auto pmap, const uint32_t &scc_id, uint32_t &count) {
+                count++;
+            });
+        }
+    }
+
+    uint32_t local_max = 0;
+
+    scc_sizes.for_all([&local_max](const uint32_t &scc_id, const uint32_t &size) {
+        local_max = std::max(local_max, size);
+    });
+
+    return ygm::max(local_max, world);
+}
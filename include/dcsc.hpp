@@ -0,0 +1,177 @@
+#pragma once
+#include <ygm/comm.hpp>
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+
+#include "graph_util.hpp"
+#include "compaction.hpp"
+#include "csr_graph.hpp"
+#include "scc_dcsc_regular.hpp"
+#include "scc_dcsc_csr.hpp"
+#include "scc_coloring_regular.hpp"
+#include "scc_coloring_csr.hpp"
+#include "phase_stats.hpp"
+
+struct DcscConfig {
+    /// SCC engine run each iteration: "pivot" (DCSC pivot marking) or "coloring" (max-label coloring).
+    std::string engine = "pivot";
+    /// Pivot choice of the pivot engine: "random" (seeded permutation) or "degree" (largest in*out degree class,
+    /// permutation on ties); see pivot_priority.hpp.
+    std::string pivots = "random";
+    /// Print the "Stopped @" phase markers and per-iteration counts on rank 0.
+    bool verbose = false;
+    /// Peel off the SCC of the highest in*out degree vertex with one forward-backward pass before iteration 0.
+    bool fwbw_opening = false;
+    /// Also retire mutually connected pairs (Trim-2) in every trim pass.
+    bool trim2 = false;
+    /// Run prop_pivots in direction-optimizing push/pull rounds (prop_pivots_push_pull).
+    bool push_pull = false;
+    /// Retire marked SCCs during the shear sweep instead of in prep_unterminated, which then shrinks to a
+    /// barrier-free reset_unterminated; per-phase stats report shear and detection together. Without push_pull
+    /// the pivot engine also seeds and propagates its pivots in one phase (mark_wcc_pivots), which leaves
+    /// three barriers (trim, pivots, shear) and one reduction per iteration.
+    bool pipelined = false;
+    /// Map graph only: compact the terminated vertices out of the map after an iteration that leaves fewer than
+    /// this fraction of its vertices unterminated (0 never compacts); see compaction.hpp.
+    double compact_below = 0;
+};
+
+/**
+ * @brief Run DCSC iterations on a built graph until every vertex has its final SCC.
+ *
+ * Starts at iteration iter with unterminated vertices still active (a fresh
+ * graph is iteration 0 with any nonzero count) and calls
+ * after_iteration(next_iter, unterminated) once per iteration. Returns the
+ * number of the next iteration.
+ *
+ * With config.compact_below the map holds only the vertices not compacted
+ * yet while after_iteration runs; a caller that needs the others passes
+ * its own compacted store and reads them from it (save_checkpoint takes
+ * it). Every vertex is back in the map when this returns.
+ */
+template <typename Graph, typename AfterIteration>
+inline size_t run_dcsc_iterations(ygm::comm &world, Graph& graph, PhaseRecorder& stats, const DcscConfig& config,
+                                  size_t iter, size_t unterminated, AfterIteration after_iteration,
+                                  BasicCompactedVertices<vertex_id_t<Graph>>* compacted = nullptr)
+{
+    const bool verbose = config.verbose;
+
+    using vertex_type = vertex_id_t<Graph>;
+
+    vertex_type max_vtx;
+    vertex_type min_vtx;
+
+    find_vertex_range(world, graph, min_vtx, max_vtx);
+    world.barrier();
+
+    auto marker = [&world, verbose](const char* phase) {
+        if (verbose) {
+            world.cout0() << "Stopped @ " << phase << std::endl;
+        }
+    };
+
+    // vertices that lost edges since the last trim; the first trim sweeps everything
+    BasicTrimWorklist<vertex_type> trim_work;
+    // vertices still active after the last prep_unterminated; built by the first one
+    BasicActiveList<vertex_type> active;
+    // terminated vertices compacted out of a map graph
+    BasicCompactedVertices<vertex_type> own_compacted;
+    if (!compacted) {
+        compacted = &own_compacted;
+    }
+
+    auto propagate = [&] {
+        if (config.push_pull) {
+            prop_pivots_push_pull(world, graph, min_vtx, max_vtx, &active);
+        } else {
+            prop_pivots(world, graph, &active);
+        }
+    };
+
+    if (config.fwbw_opening && iter == 0 && unterminated) {
+        stats.run(iter, "fwbw_trim", graph, [&] { trim_trivial(world, graph, &trim_work, config.trim2); });
+        vertex_type pivot = -1;
+        stats.run(iter, "fwbw_pivot", graph, [&] { pivot = init_fwbw_pivot(world, graph); });
+        stats.run(iter, "fwbw_prop", graph, propagate);
+        size_t remaining;
+        if (config.pipelined) {
+            unterminated = ygm::sum(local_active_count(graph), world);
+            stats.run(iter, "fwbw_shear", graph, [&] { shear_edges(world, graph, &trim_work, &active, true); });
+            stats.run(iter, "fwbw_reset", graph, [&] { remaining = reset_unterminated(world, graph, &active); });
+        } else {
+            stats.run(iter, "fwbw_shear", graph, [&] { shear_edges(world, graph, &trim_work, &active); });
+            stats.run(iter, "fwbw_detect", graph, [&] { unterminated = prep_unterminated(world, graph, &active); });
+            remaining = ygm::sum(local_active_count(graph), world);
+        }
+
+        if (verbose) {
+            world.cout0() << "FW-BW from pivot " << pivot << " finalized an SCC of " << unterminated - remaining
+                          << ", left " << remaining << " unterminated." << std::endl;
+        }
+        unterminated = remaining;
+    }
+
+    PivotPolicy pivots = PivotPolicy::random;
+    parse_pivot_policy(config.pivots, pivots);
+
+    while(unterminated) {
+        marker("trim-trivial");
+        stats.run(iter, "trim_trivial", graph, [&] { trim_trivial(world, graph, &trim_work, config.trim2); });
+        if (config.engine == "coloring") {
+            marker("color forward");
+            stats.run(iter, "color_forward", graph, [&] { color_forward(world, graph, &active); });
+            marker("color backward");
+            stats.run(iter, "color_backward", graph, [&] { color_backward(world, graph, &active); });
+            marker("shear colors");
+            stats.run(iter, "shear_colors", graph, [&] { shear_colors(world, graph, &trim_work, &active, config.pipelined); });
+        } else {
+            if (config.pipelined && !config.push_pull) {
+                marker("mark pivots");
+                stats.run(iter, "mark_wcc_pivots", graph, [&] { mark_wcc_pivots(world, graph, iter, min_vtx, max_vtx, &active, pivots); });
+            } else {
+                marker("init pivots");
+                stats.run(iter, "init_wcc_pivots", graph, [&] { init_wcc_pivots(world, graph, iter, min_vtx, max_vtx, &active, pivots); });
+                marker("prop pivots");
+                stats.run(iter, "prop_pivots", graph, propagate);
+            }
+            marker("shear edges");
+            stats.run(iter, "shear_edges", graph, [&] { shear_edges(world, graph, &trim_work, &active, config.pipelined); });
+        }
+        if (config.pipelined) {
+            marker("reset unterminated");
+            stats.run(iter, "reset_unterminated", graph, [&] { unterminated = reset_unterminated(world, graph, &active); });
+        } else {
+            marker("detect-term");
+            stats.run(iter, "prep_unterminated", graph, [&] { unterminated = prep_unterminated(world, graph, &active); });
+        }
+        if (verbose) {
+            world.cout0() << "Iteration " << iter << " left " << unterminated << " unterminated." << std::endl;
+        }
+        if constexpr (!std::is_same_v<Graph, CsrGraph>) {
+            // unterminated still counts the SCCs detected this iteration; the rebuilt active list does not
+            size_t still_active = config.compact_below > 0 ? ygm::sum(active.vertices.size(), world) : 0;
+            if (still_active && still_active < config.compact_below * ygm::sum(graph.local_size(), world)) {
+                marker("compact");
+                size_t left = 0;
+                stats.run(iter, "compact", graph, [&] { left = compact_terminated(world, graph, *compacted, &trim_work); });
+                if (verbose) {
+                    world.cout0() << "Compacted the graph to " << left << " vertices." << std::endl;
+                }
+            }
+        }
+        ++iter;
+
+        after_iteration(iter, unterminated);
+    }
+
+    if constexpr (!std::is_same_v<Graph, CsrGraph>) {
+        if (config.compact_below > 0) {
+            restore_compacted(world, graph, *compacted);
+        }
+    }
+    world.barrier();
+
+    return iter;
+}
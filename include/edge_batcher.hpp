@@ -0,0 +1,111 @@
+#pragma once
+#include <ygm/comm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <cereal/types/vector.hpp>
+
+/// Edges per message when batching graph construction; 0 sends one message per edge endpoint.
+constexpr size_t kDefaultEdgeBatch = 4096;
+
+/**
+ * @brief Ships edges to their owners in packed per-rank batches during construction.
+ *
+ * add(src, dst, ...) appends the edge to the out-batch of src's owner and
+ * the in-batch of dst's owner; a batch is sent as one message carrying a
+ * flat array of VertexId once it holds batch_size edges. finish() flushes the
+ * partial batches, waits for delivery and then sorts the received edges,
+ * dropping duplicates and self-loops in one pass. A vertex whose only edges
+ * were self-loops is kept in loop_vertices() so it still exists in the graph.
+ */
+template <typename VertexId>
+class BasicEdgeBatcher {
+public:
+    using edge_list = std::vector<std::pair<VertexId, VertexId>>;
+
+    BasicEdgeBatcher(ygm::comm& world, size_t batch_size)
+        : m_world(world), m_batch_size(std::max<size_t>(batch_size, 1)), m_out_batches(world.size()), m_in_batches(world.size()) {
+        p_self() = this;
+    }
+
+    void add(VertexId src, VertexId dst, int src_owner, int dst_owner) {
+        push(m_out_batches, src_owner, src, dst, false);
+        push(m_in_batches, dst_owner, dst, src, true);
+    }
+
+    void finish() {
+        for (int dest = 0; dest < m_world.size(); ++dest) {
+            send(m_out_batches, dest, false);
+            send(m_in_batches, dest, true);
+        }
+        m_world.barrier();
+
+        normalize(m_out_edges, &m_loop_vertices);
+        normalize(m_in_edges, nullptr);
+        std::sort(m_loop_vertices.begin(), m_loop_vertices.end());
+        m_loop_vertices.erase(std::unique(m_loop_vertices.begin(), m_loop_vertices.end()), m_loop_vertices.end());
+    }
+
+    /// (owned src, dst) and (owned dst, src) pairs, sorted and unique after finish().
+    edge_list& out_edges() { return m_out_edges; }
+    edge_list& in_edges() { return m_in_edges; }
+    std::vector<VertexId>& loop_vertices() { return m_loop_vertices; }
+
+private:
+    static BasicEdgeBatcher*& p_self() {
+        static BasicEdgeBatcher* self = nullptr;
+        return self;
+    }
+
+    void push(std::vector<std::vector<VertexId>>& batches, int dest, VertexId vtx, VertexId nbr, bool reverse) {
+        auto& batch = batches[dest];
+        batch.push_back(vtx);
+        batch.push_back(nbr);
+        if (batch.size() >= 2 * m_batch_size) {
+            send(batches, dest, reverse);
+        }
+    }
+
+    void send(std::vector<std::vector<VertexId>>& batches, int dest, bool reverse) {
+        if (batches[dest].empty()) {
+            return;
+        }
+        m_world.async(dest, [](const std::vector<VertexId>& packed, bool reverse) {
+            edge_list& edges = reverse ? p_self()->m_in_edges : p_self()->m_out_edges;
+            for (size_t i = 0; i + 1 < packed.size(); i += 2) {
+                edges.emplace_back(packed[i], packed[i + 1]);
+            }
+        }, batches[dest], reverse);
+        batches[dest].clear();
+    }
+
+    static void normalize(edge_list& edges, std::vector<VertexId>* loops) {
+        std::sort(edges.begin(), edges.end());
+        size_t w = 0;
+        for (size_t r = 0; r < edges.size(); ++r) {
+            if (edges[r].first == edges[r].second) {
+                if (loops) {
+                    loops->push_back(edges[r].first);
+                }
+            } else if (w == 0 || edges[r] != edges[w - 1]) {
+                edges[w++] = edges[r];
+            }
+        }
+        edges.resize(w);
+        edges.shrink_to_fit();
+    }
+
+    ygm::comm& m_world;
+    size_t m_batch_size;
+    std::vector<std::vector<VertexId>> m_out_batches;
+    std::vector<std::vector<VertexId>> m_in_batches;
+
+    edge_list m_out_edges;
+    edge_list m_in_edges;
+    std::vector<VertexId> m_loop_vertices;
+};
+
+using EdgeBatcher = BasicEdgeBatcher<uint32_t>;
@@ -0,0 +1,126 @@
+#pragma once
+#include <ygm/comm.hpp>
+#include <ygm/io/line_parser.hpp>
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Allocation-free parsing of text edge lists.
+ *
+ * A line is "src dst [weight ...]" with space or tab separated columns;
+ * extra columns are ignored. Comment lines ('#', '%') and any line whose
+ * first two columns are not unsigned integers are skipped, as they were
+ * with the std::istringstream based reader.
+ */
+
+inline bool is_edge_separator(char c) { return c == ' ' || c == '\t'; }
+
+/// Parse the first two columns of [first, last) into src and dst.
+template <typename Id>
+inline bool parse_edge_line(const char* first, const char* last, Id& src, Id& dst) {
+    while (first != last && is_edge_separator(*first)) {
+        ++first;
+    }
+
+    auto [src_end, src_ec] = std::from_chars(first, last, src);
+    if (src_ec != std::errc() || src_end == last || !is_edge_separator(*src_end)) {
+        return false;
+    }
+
+    first = src_end;
+    while (first != last && is_edge_separator(*first)) {
+        ++first;
+    }
+
+    auto [dst_end, dst_ec] = std::from_chars(first, last, dst);
+    return dst_ec == std::errc();
+}
+
+/// Call fn(line_begin, line_end) for every line that starts in [first, last) of a buffer ending at end.
+template <typename Function>
+inline void for_each_line_in_chunk(const char* first, const char* last, const char* end, Function& fn) {
+    while (first < last) {
+        const char* eol = static_cast<const char*>(std::memchr(first, '\n', end - first));
+        if (eol == nullptr) {
+            eol = end;
+        }
+        fn(first, eol);
+        first = eol + 1;
+    }
+}
+
+/**
+ * @brief Call fn(src, dst) for this rank's share of a text edge list.
+ *
+ * A regular file is memory-mapped and split into P byte ranges; each rank
+ * parses the lines that start in its range straight out of the mapping.
+ * Anything else (e.g. a directory of files) goes through
+ * ygm::io::line_parser with the same tokenizer.
+ */
+template <typename Id = uint32_t, typename Function>
+inline void for_all_text_edges(ygm::comm &world, const std::string& edgelist_file, Function fn) {
+    auto parse = [&fn](const char* first, const char* last) {
+        Id src, dst;
+        if (parse_edge_line(first, last, src, dst)) {
+            fn(src, dst);
+        }
+    };
+
+    struct stat st;
+    if (::stat(edgelist_file.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        ygm::io::line_parser lp(world, {edgelist_file});
+        lp.for_all([&parse](const std::string& line) {
+            parse(line.data(), line.data() + line.size());
+        });
+        return;
+    }
+
+    const uint64_t file_size = st.st_size;
+    uint64_t begin = file_size * world.rank() / world.size();
+    const uint64_t end = file_size * (world.rank() + 1) / world.size();
+    if (begin >= end) {
+        return;
+    }
+
+    int fd = ::open(edgelist_file.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open edge list " + edgelist_file);
+    }
+
+    // Map from the byte before the range (to find where the first line starts)
+    // through the end of the file, since the last line may run past 'end'.
+    const uint64_t page = ::sysconf(_SC_PAGESIZE);
+    const uint64_t lookback = begin > 0 ? begin - 1 : 0;
+    const uint64_t map_begin = lookback - lookback % page;
+    void* base = ::mmap(nullptr, file_size - map_begin, PROT_READ, MAP_PRIVATE, fd, map_begin);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        throw std::runtime_error("cannot mmap edge list " + edgelist_file);
+    }
+    ::madvise(base, file_size - map_begin, MADV_SEQUENTIAL);
+
+    auto at = [base, map_begin](uint64_t offset) {
+        return static_cast<const char*>(base) + (offset - map_begin);
+    };
+
+    // A line belongs to the rank whose range holds its first byte.
+    if (begin > 0 && *at(begin - 1) != '\n') {
+        const char* eol = static_cast<const char*>(std::memchr(at(begin), '\n', file_size - begin));
+        begin = eol ? uint64_t(eol - at(begin)) + begin + 1 : file_size;
+    }
+
+    if (begin < end) {
+        for_each_line_in_chunk(at(begin), at(end), at(file_size), parse);
+    }
+
+    ::munmap(base, file_size - map_begin);
+}
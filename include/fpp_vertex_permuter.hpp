@@ -1,6 +1,8 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <type_traits>
 
 /**
  * @brief Reproducible, bijective, format-preserving permutation over [min_id, max_id].
@@ -14,13 +16,29 @@
  *   - Reproducible given the same (min_id, max_id, seed)
  *   - O(1) memory, SPMD-friendly (no comms)
  *   - True permutation of [min_id, max_id] (no collisions)
+ *
+ * When R is a power of two (or the full range of Id) no walking is needed.
+ * permute() and any_below() work on arrays of ids in blocks of kLanes,
+ * written as branch-free loops over the lanes so the compiler can turn
+ * them into AVX2 / AVX-512 code, with walking repeated only while some
+ * lane of the block is still outside the range.
+ *
+ * Id is the vertex id type, uint32_t or uint64_t. The 64-bit variant runs
+ * the same rounds on 64-bit words with 64-bit round constants; FppPermuter
+ * is the 32-bit one.
  */
-class FppPermuter {
+template <typename Id = uint32_t>
+class BasicFppPermuter {
+  static_assert(std::is_same_v<Id, uint32_t> || std::is_same_v<Id, uint64_t>, "32- or 64-bit vertex ids");
+
 public:
-  using u32 = uint32_t;
+  using id_type = Id;
   using u64 = uint64_t;
 
-  FppPermuter(u32 min_id, u32 max_id, u64 seed)
+  /// Ids permuted together by the batch calls: one AVX-512 register of Id.
+  static constexpr size_t kLanes = 64 / sizeof(Id);
+
+  BasicFppPermuter(Id min_id, Id max_id, u64 seed)
       : min_id_(min_id), max_id_(max_id), seed_(seed) {
     // Handle empty/degenerate ranges defensively.
     if (max_id_ <= min_id_) {
@@ -28,56 +46,96 @@ public:
       min_id_ = 0;
       max_id_ = 0;
     }
-    const u64 R64 = static_cast<u64>(max_id_) - static_cast<u64>(min_id_) + 1ull;
+    const Id span = max_id_ - min_id_;   // R - 1
 
-    // R==0 means full 2^32 range.
-    full_32bit_range_ = (R64 >= (1ull << 32));
-    if (!full_32bit_range_) {
-      R_ = static_cast<u32>(R64);
+    // R == 2^kBits does not fit in Id
+    full_range_ = (span == kAllOnes);
+    if (!full_range_) {
+      R_ = span + 1;
       m_ = (R_ <= 1u) ? 1u : ceil_log2_u64(R_);
-      mask_ = (m_ == 32u) ? 0xFFFFFFFFu : ((1u << m_) - 1u);
+      mask_ = (m_ == kBits) ? kAllOnes : ((Id(1) << m_) - 1u);
     } else {
       R_ = 0u;
-      m_ = 32u;
-      mask_ = 0xFFFFFFFFu;
+      m_ = kBits;
+      mask_ = kAllOnes;
     }
+    pow2_range_ = full_range_ || (m_ < kBits && R_ == (Id(1) << m_));
 
-    key_ = mix_key64_to_32(seed_);
+    key_ = mix_key(seed_);
     // Derive two odd round constants from key (cached)
-    k1_ = key_ * 0x9E3779B1u + 0x85EBCA77u; k1_ |= 1u;
-    k2_ = key_ * 0xC2B2AE3Du + 0x27D4EB2Fu; k2_ |= 1u;
+    if constexpr (kBits == 32) {
+      k1_ = key_ * 0x9E3779B1u + 0x85EBCA77u; k1_ |= 1u;
+      k2_ = key_ * 0xC2B2AE3Du + 0x27D4EB2Fu; k2_ |= 1u;
+    } else {
+      k1_ = key_ * 0x9E3779B97F4A7C15ull + 0xBF58476D1CE4E5B9ull; k1_ |= 1u;
+      k2_ = key_ * 0xC2B2AE3D27D4EB4Full + 0x94D049BB133111EBull; k2_ |= 1u;
+    }
   }
 
   /// Permute a single id. If it's outside [min_id, max_id], returns it unchanged.
-  inline u32 operator()(u32 id) const {
+  inline Id operator()(Id id) const {
     if (id < min_id_ || id > max_id_) return id;
 
-    if (full_32bit_range_) {
-      // Full 2^32: direct bijection (no cycle walking).
-      const u32 x = id - min_id_;
-      const u32 y = permute_pow2(x);
+    if (pow2_range_) {
+      // R == 2^m (including the full range): direct bijection (no cycle walking).
+      const Id x = id - min_id_;
+      const Id y = permute_pow2(x);
       return y + min_id_;
     } else {
-      const u32 x0 = id - min_id_;
+      const Id x0 = id - min_id_;
       return fpp_permute_in_range(x0) + min_id_;
     }
   }
 
+  /// out[i] = (*this)(ids[i]) for i < n; out may be ids itself.
+  inline void permute(const Id* ids, Id* out, size_t n) const {
+    size_t i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+      permute_lanes(ids + i, out + i);
+    }
+    for (; i < n; ++i) {
+      out[i] = (*this)(ids[i]);
+    }
+  }
+
+  /// Whether some ids[i] permutes to a value below bound; stops after the first block that has one.
+  inline bool any_below(const Id* ids, size_t n, Id bound) const {
+    Id block[kLanes];
+    size_t i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+      permute_lanes(ids + i, block);
+      Id hit = 0;
+      for (size_t j = 0; j < kLanes; ++j) hit |= block[j] < bound;
+      if (hit) return true;
+    }
+    for (; i < n; ++i) {
+      if ((*this)(ids[i]) < bound) return true;
+    }
+    return false;
+  }
+
   /// Accessors
-  inline u32 min_id() const { return min_id_; }
-  inline u32 max_id() const { return max_id_; }
+  inline Id  min_id() const { return min_id_; }
+  inline Id  max_id() const { return max_id_; }
   inline u64 seed()   const { return seed_;   }
 
 private:
+  static constexpr unsigned kBits = 8 * sizeof(Id);
+  static constexpr Id kAllOnes = ~Id(0);
+
   // --- Helpers ---------------------------------------------------------------
 
-  static inline u32 mix_key64_to_32(u64 seed) {
-    // SplitMix64 finalizer, then fold to 32 bits.
+  static inline Id mix_key(u64 seed) {
+    // SplitMix64 finalizer; the 32-bit variant folds it to 32 bits.
     u64 z = seed + 0x9E3779B97F4A7C15ull;
     z ^= (z >> 30); z *= 0xBF58476D1CE4E5B9ull;
     z ^= (z >> 27); z *= 0x94D049BB133111EBull;
     z ^= (z >> 31);
-    return static_cast<u32>((z ^ (z >> 32)) & 0xFFFFFFFFu);
+    if constexpr (kBits == 32) {
+      return static_cast<Id>((z ^ (z >> 32)) & 0xFFFFFFFFu);
+    } else {
+      return z;
+    }
   }
 
   static inline unsigned ceil_log2_u64(u64 n) {
@@ -87,9 +145,9 @@ private:
     return l;
   }
 
-  inline u32 permute_pow2(u32 x) const {
+  inline Id permute_pow2(Id x) const {
     // Bijective on {0..2^m-1}; all ops masked by 'mask_' (mod 2^m).
-    u32 v = x & mask_;
+    Id v = x & mask_;
     v ^= key_;                     v &= mask_;
     v ^= (v >> (m_/2 ? m_/2 : 1)); v &= mask_;
     v = mul_masked(v, k1_);        v &= mask_;
@@ -100,30 +158,57 @@ private:
     return v;
   }
 
-  inline u32 fpp_permute_in_range(u32 x_in_range) const {
+  inline Id fpp_permute_in_range(Id x_in_range) const {
     // Cycle-walk until the result falls in [0, R_)
-    u32 x = x_in_range;
+    Id x = x_in_range;
     do {
       x = permute_pow2(x);
     } while (x >= R_);
     return x;
   }
 
-  inline u32 mul_masked(u32 x, u32 k) const {
+  inline void permute_lanes(const Id* ids, Id* out) const {
+    // Out-of-range ids pass through unchanged; their lanes walk from 0 meanwhile,
+    // since a start inside [0, R) is what guarantees that walking ends.
+    Id x[kLanes];
+    Id in_range[kLanes];
+    for (size_t j = 0; j < kLanes; ++j) {
+      in_range[j] = ids[j] >= min_id_ && ids[j] <= max_id_;
+      x[j] = in_range[j] ? ids[j] - min_id_ : Id(0);
+    }
+
+    for (size_t j = 0; j < kLanes; ++j) x[j] = permute_pow2(x[j]);
+
+    if (!pow2_range_) {
+      for (;;) {
+        Id walking = 0;
+        for (size_t j = 0; j < kLanes; ++j) walking |= x[j] >= R_;
+        if (!walking) break;
+        for (size_t j = 0; j < kLanes; ++j) x[j] = x[j] >= R_ ? permute_pow2(x[j]) : x[j];
+      }
+    }
+
+    for (size_t j = 0; j < kLanes; ++j) out[j] = in_range[j] ? x[j] + min_id_ : ids[j];
+  }
+
+  inline Id mul_masked(Id x, Id k) const {
     // Multiplication modulo 2^m is equivalent to normal mul then mask.
     // k is odd by construction.
     return (x * k) & mask_;
   }
 
   // --- Data ------------------------------------------------------------------
-  u32 min_id_{0}, max_id_{0};
+  Id  min_id_{0}, max_id_{0};
   u64 seed_{0};
 
-  bool full_32bit_range_{false};
-  u32  R_{0};        // range size, or 0 meaning 2^32
-  unsigned m_{32};   // bits of the pow2 domain
-  u32  mask_{0xFFFFFFFFu};
+  bool full_range_{false};
+  bool pow2_range_{false};  // R == 2^m: permute_pow2 alone stays in range
+  Id   R_{0};        // range size, or 0 meaning 2^kBits
+  unsigned m_{kBits};  // bits of the pow2 domain
+  Id   mask_{kAllOnes};
 
-  u32  key_{0};      // mixed 32-bit key from seed
-  u32  k1_{0}, k2_{0}; // odd round constants
+  Id   key_{0};      // mixed key from seed
+  Id   k1_{0}, k2_{0}; // odd round constants
 };
+
+using FppPermuter = BasicFppPermuter<uint32_t>;
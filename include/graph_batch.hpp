@@ -0,0 +1,141 @@
+#pragma once
+#include <ygm/comm.hpp>
+#include <ygm/container/map.hpp>
+#include <ygm/detail/collective.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "graph_util.hpp"
+#include "scc_output.hpp"
+
+/**
+ * @brief Batch mode: many edge lists solved in one ygm::comm session.
+ *
+ * A manifest names one edge list per line (blank lines and `#` comments are
+ * skipped). run_dcsc either solves them one after the other, reusing its
+ * graph container, or packs them into one graph and solves that in a
+ * single DCSC pass. Graphs share no edges, so their SCCs are those of the
+ * packed graph.
+ *
+ * Packing moves the ids of graph g up by the sum of the largest ids of the
+ * graphs before it, so every graph owns the id range (offsets[g],
+ * offsets[g + 1]]. The offsets need one collective pass over each edge list
+ * to find its largest id.
+ */
+inline std::vector<std::string> read_batch_manifest(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("cannot open batch manifest " + path);
+    }
+
+    std::vector<std::string> files;
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+        size_t last = line.find_last_not_of(" \t\r");
+        files.push_back(line.substr(first, last - first + 1));
+    }
+    if (files.empty()) {
+        throw std::runtime_error("batch manifest " + path + " names no edge lists");
+    }
+    return files;
+}
+
+struct PackedBatch {
+    std::vector<std::string> files;
+    /// offsets[g] is added to the (shifted) ids of graph g; offsets.back() is the largest packed id.
+    std::vector<uint64_t> offsets;
+
+    /// Graph a packed id belongs to.
+    size_t graph_of(uint64_t vtx) const {
+        return std::upper_bound(offsets.begin(), offsets.end() - 1, vtx - 1) - offsets.begin() - 1;
+    }
+};
+
+/// Collectively find the id range of every edge list in files; throws std::overflow_error if they do not fit VertexId together.
+template <typename VertexId>
+inline PackedBatch pack_batch(ygm::comm& world, const std::vector<std::string>& files) {
+    PackedBatch batch;
+    batch.files = files;
+    batch.offsets.push_back(0);
+    for (const std::string& file : files) {
+        uint64_t largest = 0;
+        for_all_edges<VertexId>(world, file, [&largest](VertexId src, VertexId dst) {
+            largest = std::max<uint64_t>(largest, std::max(src, dst));
+        });
+        largest = ygm::max(largest, world);
+
+        // the same room for_all_edges leaves: the largest id stays below VertexId(-1)
+        if (largest > uint64_t(std::numeric_limits<VertexId>::max()) - 1 - batch.offsets.back()) {
+            throw std::overflow_error("the packed batch does not fit the " + std::to_string(8 * sizeof(VertexId)) +
+                                      "-bit vertex id type");
+        }
+        batch.offsets.push_back(batch.offsets.back() + largest);
+    }
+    return batch;
+}
+
+/// fn(src, dst) for this rank's share of every edge list of the batch, in packed ids.
+template <typename VertexId, typename Function>
+inline void for_all_packed_edges(ygm::comm& world, const PackedBatch& batch, Function fn) {
+    for (size_t g = 0; g < batch.files.size(); ++g) {
+        VertexId offset = VertexId(batch.offsets[g]);
+        for_all_edges<VertexId>(world, batch.files[g], [&fn, offset](VertexId src, VertexId dst) {
+            fn(src + offset, dst + offset);
+        });
+    }
+}
+
+struct PackedGraphSummary {
+    uint64_t vertices = 0;
+    uint64_t sccs = 0;
+    uint64_t largest = 0;
+};
+
+/// Collectively count the vertices, SCCs and largest SCC of every graph of a solved packed batch.
+template <typename Graph>
+inline std::vector<PackedGraphSummary> summarize_packed_batch(ygm::comm& world, Graph& graph, const PackedBatch& batch) {
+    using vertex_type = vertex_id_t<Graph>;
+
+    const size_t n = batch.files.size();
+    std::vector<uint64_t> counts(3 * n, 0);   // vertices, SCCs and largest SCC of each graph
+
+    ygm::container::map<vertex_type, uint64_t> scc_sizes(world);
+    detail::for_all_local_components(graph, [&](vertex_type vtx, vertex_type comp) {
+        size_t g = batch.graph_of(vtx);
+        ++counts[3 * g];
+        counts[3 * g + 1] += comp == vtx;
+        scc_sizes.async_visit(comp, [](const vertex_type& label, uint64_t& size) { ++size; });
+    });
+    world.barrier();
+
+    scc_sizes.local_for_all([&](const vertex_type& label, const uint64_t& size) {
+        uint64_t& largest = counts[3 * batch.graph_of(label) + 2];
+        largest = std::max(largest, size);
+    });
+
+    counts = world.all_reduce(counts, [](const std::vector<uint64_t>& a, const std::vector<uint64_t>& b) {
+        std::vector<uint64_t> merged(a);
+        for (size_t i = 0; i < merged.size(); i += 3) {
+            merged[i] += b[i];
+            merged[i + 1] += b[i + 1];
+            merged[i + 2] = std::max(merged[i + 2], b[i + 2]);
+        }
+        return merged;
+    });
+
+    std::vector<PackedGraphSummary> summaries(n);
+    for (size_t g = 0; g < n; ++g) {
+        summaries[g] = {counts[3 * g], counts[3 * g + 1], counts[3 * g + 2]};
+    }
+    return summaries;
+}
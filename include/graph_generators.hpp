@@ -0,0 +1,146 @@
+#pragma once
+#include <ygm/comm.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+/**
+ * @brief Distributed synthetic directed graphs, generated on the fly.
+ *
+ * Each rank generates its contiguous share of the edge index range
+ * [0, num_edges()). Every edge draws from its own stream keyed by (seed,
+ * edge index) rather than by rank, so the same parameters give the same graph
+ * on any number of ranks. Vertex ids are scrambled with a bijection of
+ * [0, 2^scale) so that hubs do not cluster at small ids, and are passed
+ * shifted up by one like for_all_edges() does for edge lists.
+ *
+ *   rmat:    R-MAT / Kronecker with initiator (a, b, c, 1 - a - b - c)
+ *   er:      Erdos-Renyi G(n, m) with m = edge_factor * n
+ *   planted: `sccs` blocks of consecutive ids, each a directed cycle plus
+ *            random intra-block edges, with cross-block edges only from a
+ *            block to later blocks; so exactly `sccs` SCCs, the largest
+ *            holding ceil(n / sccs) vertices
+ */
+struct GeneratorParams {
+    std::string kind = "rmat";
+    uint32_t scale = 16;          // n = 2^scale vertices
+    uint32_t edge_factor = 16;    // m = edge_factor * n edges
+    uint64_t sccs = 16;           // planted only
+    uint64_t seed = 1;
+    double a = 0.57, b = 0.19, c = 0.19;
+
+    uint64_t num_vertices() const { return uint64_t(1) << scale; }
+    uint64_t num_edges() const { return uint64_t(edge_factor) << scale; }
+
+    void validate() const {
+        if (kind != "rmat" && kind != "er" && kind != "planted") {
+            throw std::invalid_argument("unknown generator '" + kind + "'");
+        }
+        if (scale < 1 || scale > 31) {
+            throw std::invalid_argument("scale must be in [1, 31] for 32-bit vertex ids");
+        }
+        if (edge_factor < 1) {
+            throw std::invalid_argument("edge factor must be at least 1");
+        }
+        if (kind == "planted" && (sccs < 1 || sccs > num_vertices())) {
+            throw std::invalid_argument("planted SCC count must be in [1, 2^scale]");
+        }
+    }
+};
+
+namespace detail {
+
+inline uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/// Deterministic random stream for one edge index.
+class EdgeRng {
+public:
+    EdgeRng(uint64_t seed, uint64_t edge) : m_state(seed * 0xD1B54A32D192ED03ull ^ edge) {
+        splitmix64(m_state);
+    }
+
+    uint64_t next() { return splitmix64(m_state); }
+    double uniform() { return (next() >> 11) * 0x1.0p-53; }
+    uint64_t below(uint64_t n) { return next() % n; }
+
+private:
+    uint64_t m_state;
+};
+
+/// Bijection of [0, 2^scale): odd multiplier plus offset, modulo 2^scale.
+inline uint32_t scramble(uint64_t vtx, uint64_t mask) {
+    return uint32_t((vtx * 0x9E3779B97F4A7C15ull + 0x632BE59BD9B4E019ull) & mask);
+}
+
+inline uint64_t rmat_vertex_pair(EdgeRng& rng, const GeneratorParams& p, uint64_t& dst) {
+    uint64_t src = 0;
+    dst = 0;
+    for (uint32_t level = 0; level < p.scale; ++level) {
+        double r = rng.uniform();
+        uint64_t src_bit = r >= p.a + p.b;
+        uint64_t dst_bit = (r >= p.a && r < p.a + p.b) || r >= p.a + p.b + p.c;
+        src = (src << 1) | src_bit;
+        dst = (dst << 1) | dst_bit;
+    }
+    return src;
+}
+
+} // namespace detail
+
+/**
+ * @brief Call fn(src, dst) for this rank's share of the generated edges.
+ */
+template <typename Function>
+inline void for_all_generated_edges(ygm::comm &world, const GeneratorParams& params, Function fn) {
+    params.validate();
+
+    const uint64_t n = params.num_vertices();
+    const uint64_t m = params.num_edges();
+    const uint64_t mask = n - 1;
+    const uint64_t first = m * world.rank() / world.size();
+    const uint64_t last = m * (world.rank() + 1) / world.size();
+    const bool rmat = params.kind == "rmat";
+    const bool er = params.kind == "er";
+
+    auto block_begin = [&params, n](uint64_t b) { return b * n / params.sccs; };
+    auto block_of = [&params, n](uint64_t v) {
+        uint64_t b = v * params.sccs / n;
+        while ((b + 1) * n / params.sccs <= v) ++b;
+        while (b * n / params.sccs > v) --b;
+        return b;
+    };
+
+    for (uint64_t e = first; e < last; ++e) {
+        detail::EdgeRng rng(params.seed, e);
+        uint64_t src, dst;
+        if (rmat) {
+            src = detail::rmat_vertex_pair(rng, params, dst);
+        } else if (er) {
+            src = rng.below(n);
+            dst = rng.below(n);
+        } else if (e < n) {
+            // cycle edge e -> next vertex of its block
+            uint64_t b = block_of(e);
+            src = e;
+            dst = e + 1 < block_begin(b + 1) ? e + 1 : block_begin(b);
+        } else {
+            src = rng.below(n);
+            uint64_t b = block_of(src);
+            if (b + 1 < params.sccs && rng.uniform() < 0.2) {
+                uint64_t lo = block_begin(b + 1);
+                dst = lo + rng.below(n - lo);
+            } else {
+                uint64_t lo = block_begin(b);
+                dst = lo + rng.below(block_begin(b + 1) - lo);
+            }
+        }
+
+        fn(uint32_t(detail::scramble(src, mask) + 1), uint32_t(detail::scramble(dst, mask) + 1));
+    }
+}
@@ -1,54 +1,253 @@
 #pragma once
 #include <ygm/comm.hpp>
 #include <ygm/container/map.hpp>
-#include <ygm/io/line_parser.hpp>
-#include <sstream>
+#include <ygm/detail/collective.hpp>
 // #include <iostream>
 
-#include <set>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <vector>
 
-struct VtxInfo {
-    std::set<uint32_t> out;
-    std::set<uint32_t> in;
+#include "adjacency.hpp"
+#include "binary_edgelist.hpp"
+#include "edge_batcher.hpp"
+#include "edgelist_parser.hpp"
 
-    uint64_t comp_id = -1;
-    bool active = true;
+/**
+ * @brief Per-vertex state of the vertex-map graph: 16 bytes besides the two neighbor lists.
+ *
+ * comp_id is the final SCC label once a vertex is inactive. While it is
+ * still active it holds the marker of the pivot that reached it this
+ * iteration, so detection only has to clear `active`. A vertex is a pivot
+ * while it still holds the wcc_pivot it seeded itself with; is_pivot
+ * records that, instead of the seed.
+ *
+ * The two labels and the flag byte hold 9 bytes of data, padded to 16 by
+ * the neighbor lists' 8-byte alignment. The vertex id type is the
+ * adjacency's; with 64-bit ids the labels grow to 8 bytes each and the
+ * tail to 24.
+ */
+template <typename Adjacency>
+struct BasicVtxInfo {
+    using adjacency_type = Adjacency;
+    using vertex_type = typename Adjacency::value_type;
 
-    uint32_t my_marker = -1;
-    uint32_t my_pivot = -1;
-    uint32_t wcc_pivot = -1;
+    Adjacency out;
+    Adjacency in;
 
-    bool mark_pred = false;
-    bool mark_desc = false;
+    vertex_type comp_id = -1;
+    vertex_type wcc_pivot = -1;
 
+    bool active : 1 = true;
+    bool mark_pred : 1 = false;
+    bool mark_desc : 1 = false;
+    bool is_pivot : 1 = false;
+
+    uint8_t flags() const { return active | mark_pred << 1 | mark_desc << 2 | is_pivot << 3; }
+    void set_flags(uint8_t bits) {
+        active = bits & 1;
+        mark_pred = bits & 2;
+        mark_desc = bits & 4;
+        is_pivot = bits & 8;
+    }
+
+    // bit-fields cannot be archived by reference: pack before, unpack after, so saving and loading share this
     template <class Archive>
-    void serialize(Archive& ar) { ar(out, in, comp_id, active, my_pivot, mark_pred, mark_desc); }
+    void serialize(Archive& ar) {
+        uint8_t bits = flags();
+        ar(out, in, comp_id, wcc_pivot, bits);
+        set_flags(bits);
+    }
 };
 
-inline void create_vertex_map(ygm::comm &world, const std::string& edgelist_file, ygm::container::map<uint32_t, VtxInfo>& vertex_map) {
-    if (world.rank0()) {
-        std::cout << "Reading edges from " << edgelist_file << std::endl;
+using VtxInfo = BasicVtxInfo<DefaultAdjacency>;
+static_assert(sizeof(VtxInfo) == 2 * sizeof(DefaultAdjacency) + 16, "VtxInfo layout no longer matches its doc comment");
+
+/// Free the neighbor lists of a vertex that has its final SCC; the kernels never read them again.
+template <typename Info>
+inline void release_adjacency(Info& info) {
+    info.out.clear();
+    info.in.clear();
+}
+
+/// Vertex id type of a graph container: the key of a vertex map (CsrGraph specializes it).
+template <typename Graph>
+struct vertex_id;
+
+template <typename VertexId, typename Info>
+struct vertex_id<ygm::container::map<VertexId, Info>> {
+    using type = VertexId;
+};
+
+template <typename Graph>
+using vertex_id_t = typename vertex_id<Graph>::type;
+
+/// Component label shared by every vertex during the forward-backward opening phase.
+constexpr uint32_t kFwbwPivot = 0;
+
+/**
+ * @brief Rank-local set of vertices whose degree may have changed since the last trim.
+ *
+ * Entries are vertex ids for the vertex map and local indices for CsrGraph.
+ * While `all` is set (a fresh or restored graph) nothing is recorded and the
+ * next trim sweeps every vertex.
+ */
+template <typename VertexId>
+struct BasicTrimWorklist {
+    bool all = true;
+    std::vector<VertexId> vertices;
+
+    void add(VertexId vtx) {
+        if (!all) {
+            vertices.push_back(vtx);
+        }
+    }
+
+    /// Sorted, duplicate-free entries; leaves the list empty.
+    std::vector<VertexId> take() {
+        std::vector<VertexId> out;
+        out.swap(vertices);
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+        return out;
     }
+};
 
-    ygm::io::line_parser lp(world, {edgelist_file});
-    lp.for_all([&vertex_map](const std::string& line) {
-        if (line.empty() || line[0] == '#') {
+/**
+ * @brief Rank-local list of the vertices that were still active after the last prep_unterminated.
+ *
+ * Entries are vertex ids for the vertex map and local indices for CsrGraph.
+ * Vertices trimmed since the list was rebuilt stay in it until the next
+ * rebuild, so sweeps still check `active`. While `all` is set (a fresh or
+ * restored graph) the list has not been built yet and sweeps cover every
+ * local vertex.
+ */
+template <typename VertexId>
+struct BasicActiveList {
+    bool all = true;
+    std::vector<VertexId> vertices;
+};
+
+using TrimWorklist = BasicTrimWorklist<uint32_t>;
+using ActiveList = BasicActiveList<uint32_t>;
+
+/**
+ * @brief Call fn(vtx, info) for every active local vertex.
+ *
+ * With a built ActiveList only the listed vertices are visited, so sweeps
+ * late in a run cost as much as the work that is left rather than the whole
+ * map. A lookup per listed vertex is slower than walking the map itself, so
+ * the plain sweep is kept while more than half the local vertices are listed.
+ */
+template <typename VertexId, typename Info, typename Function>
+inline void for_all_active(ygm::container::map<VertexId, Info>& vertex_map, const BasicActiveList<VertexId>* active, Function fn) {
+    auto visit = [&fn](const VertexId& vtx, Info& info) {
+        if (info.active) {
+            fn(vtx, info);
+        }
+    };
+
+    if (active == nullptr || active->all || 2 * active->vertices.size() > vertex_map.local_size()) {
+        vertex_map.local_for_all(visit);
+        return;
+    }
+
+    for (VertexId vtx : active->vertices) {
+        vertex_map.local_visit(vtx, visit);
+    }
+}
+
+/**
+ * @brief Call fn(src, dst) for this rank's share of a text or binary edge list, with ids shifted up by one. Collective.
+ *
+ * Ids are read as VertexId. An edge with an id that leaves no room for the
+ * shift below the VertexId(-1) sentinel is skipped, and once every rank has
+ * read its share they all throw std::overflow_error, so a 32-bit run over a
+ * 64-bit edge list fails instead of wrapping.
+ */
+template <typename VertexId = uint32_t, typename Function>
+inline void for_all_edges(ygm::comm &world, const std::string& edgelist_file, Function fn) {
+    bool too_large = false;
+    auto shifted = [&fn, &too_large](auto src, auto dst) {
+        // shifted ids stay below VertexId(-1), the kernels' "unset" label
+        constexpr uint64_t max_id = std::numeric_limits<VertexId>::max() - 2;
+        if (uint64_t(src) > max_id || uint64_t(dst) > max_id) {
+            too_large = true;
             return;
         }
+        fn(VertexId(src) + 1, VertexId(dst) + 1);
+    };
+
+    if (!is_binary_edgelist(edgelist_file)) {
+        // parsed 64-bit wide so that too large ids are reported, not skipped as unparsable lines
+        for_all_text_edges<uint64_t>(world, edgelist_file, shifted);
+    } else {
+        for_all_binary_edges(world, edgelist_file, shifted);
+    }
+
+    if (ygm::logical_or(too_large, world)) {
+        // deliver what fn already sent while its receivers are still alive
+        world.barrier();
+        throw std::overflow_error(edgelist_file + " has a vertex id that does not fit the " +
+                                  std::to_string(8 * sizeof(VertexId)) + "-bit vertex id type");
+    }
+}
+
+/// Insert each run of (owned vertex, neighbor) pairs into that vertex's out or in list.
+template <typename VertexId, typename Info, typename Adjacency>
+inline void add_edge_runs(ygm::container::map<VertexId, Info>& vertex_map, typename BasicEdgeBatcher<VertexId>::edge_list& edges,
+                          Adjacency Info::*side) {
+    for (size_t first = 0; first < edges.size();) {
+        size_t last = first + 1;
+        while (last < edges.size() && edges[last].first == edges[first].first) {
+            ++last;
+        }
 
-        std::istringstream iss(line);
+        auto insert_run = [&edges, first, last, side](const VertexId& vtx, Info& info) {
+            for (size_t e = first; e < last; ++e) {
+                (info.*side).insert(edges[e].second);
+            }
+        };
+        vertex_map.local_visit(edges[first].first, insert_run);
+        first = last;
+    }
 
-        uint32_t src, dst;
+    typename BasicEdgeBatcher<VertexId>::edge_list().swap(edges);
+}
 
-        if (iss >> src >> dst) {
-            src += 1;
-            dst += 1;
+/**
+ * @brief Build the vertex map from an edge source: for_each_edge(fn) calls fn(src, dst) for this rank's share of the edges.
+ *
+ * With batch_size > 0 edges travel to their owners in packed batches and are
+ * sorted and deduplicated there before one visit per vertex fills its lists;
+ * self-loops are dropped (they never change an SCC) but their vertex is kept.
+ * batch_size == 0 sends one async_visit per edge endpoint.
+ */
+template <typename EdgeSource, typename VertexId, typename Info>
+inline void create_vertex_map_from_edges(ygm::comm &world, EdgeSource&& for_each_edge, ygm::container::map<VertexId, Info>& vertex_map,
+                                         size_t batch_size = kDefaultEdgeBatch) {
+    if (batch_size > 0) {
+        BasicEdgeBatcher<VertexId> batcher(world, batch_size);
+        for_each_edge([&batcher, &vertex_map](VertexId src, VertexId dst) {
+            batcher.add(src, dst, vertex_map.partitioner.owner(src), vertex_map.partitioner.owner(dst));
+        });
+        batcher.finish();
+
+        add_edge_runs(vertex_map, batcher.out_edges(), &Info::out);
+        add_edge_runs(vertex_map, batcher.in_edges(), &Info::in);
 
-            auto add_fwd_edge = [](const uint32_t& src, VtxInfo& info, const uint32_t dst){
+        auto touch = [](const VertexId& vtx, Info& info) {};
+        for (VertexId vtx : batcher.loop_vertices()) {
+            vertex_map.local_visit(vtx, touch);
+        }
+    } else {
+        for_each_edge([&vertex_map](VertexId src, VertexId dst) {
+            auto add_fwd_edge = [](const VertexId& src, Info& info, const VertexId dst){
                 info.out.insert(dst);
             };
 
-            auto add_reverse_edge = [](const uint32_t& dst, VtxInfo& info, const uint32_t src){
+            auto add_reverse_edge = [](const VertexId& dst, Info& info, const VertexId src){
                 info.in.insert(src);
             };
 
@@ -56,18 +255,63 @@ inline void create_vertex_map(ygm::comm &world, const std::string& edgelist_file
             // vertex_map.async_insert(dst, VertexInfo{dst});
             vertex_map.async_visit(src, add_fwd_edge, dst);
             vertex_map.async_visit(dst, add_reverse_edge, src);
+        });
+
+        world.barrier();
+    }
+
+    // fold the staged inserts into sorted, duplicate-free neighbor lists
+    vertex_map.local_for_all([](const VertexId& vtx, Info& info) {
+        info.out.compact();
+        info.in.compact();
+    });
+}
+
+
+template <typename VertexId, typename Info>
+inline void create_vertex_map(ygm::comm &world, const std::string& edgelist_file, ygm::container::map<VertexId, Info>& vertex_map,
+                              size_t batch_size = kDefaultEdgeBatch) {
+    if (world.rank0()) {
+        std::cout << "Reading edges from " << edgelist_file << std::endl;
+    }
+
+    create_vertex_map_from_edges(world, [&](auto fn) { for_all_edges<VertexId>(world, edgelist_file, fn); }, vertex_map, batch_size);
+}
+
+template <typename VertexId, typename Info>
+inline void find_vertex_range(ygm::comm& world, ygm::container::map<VertexId, Info>& vertex_map, VertexId& min_vtx, VertexId& max_vtx) {
+    max_vtx = 0;
+    min_vtx = -1;
+
+    vertex_map.for_all([&max_vtx, &min_vtx](const VertexId& vtx, Info& info){
+        if (vtx > max_vtx) {
+            max_vtx = vtx;
+        }
+
+        if (vtx < min_vtx) {
+            min_vtx = vtx;
         }
     });
 
-    world.barrier();
+    max_vtx = ygm::max(max_vtx, world);
+    min_vtx = ygm::min(min_vtx, world);
 }
 
+template <typename VertexId, typename Info>
+inline size_t local_active_count(ygm::container::map<VertexId, Info>& vertex_map) {
+    size_t count = 0;
+    vertex_map.local_for_all([&count](const VertexId& vtx, const Info& info) {
+        count += info.active;
+    });
+    return count;
+}
 
-inline uint32_t count_sccs( ygm::comm& world, ygm::container::map<uint32_t, VtxInfo>& vertex_map) {
+template <typename VertexId, typename Info>
+inline uint64_t count_sccs( ygm::comm& world, ygm::container::map<VertexId, Info>& vertex_map) {
     
-    uint32_t local_count = 0;
+    uint64_t local_count = 0;
 
-    vertex_map.local_for_all([&local_count](const uint32_t &vertex, const VtxInfo &info) {
+    vertex_map.local_for_all([&local_count](const VertexId &vertex, const Info &info) {
         if (info.comp_id == vertex) {
             local_count++;
         }
@@ -76,19 +320,20 @@ inline uint32_t count_sccs( ygm::comm& world, ygm::container::map<uint32_t, VtxI
     return ygm::sum(local_count, world);
 }
 
-inline uint32_t count_largest_scc(ygm::comm& world, ygm::container::map<uint32_t, VtxInfo>& vertex_map) {
+template <typename VertexId, typename Info>
+inline uint64_t count_largest_scc(ygm::comm& world, ygm::container::map<VertexId, Info>& vertex_map) {
 
-    ygm::container::map<uint32_t, uint32_t> scc_sizes(world);
+    ygm::container::map<VertexId, uint64_t> scc_sizes(world);
 
-    vertex_map.for_all([&scc_sizes](const uint32_t &vertex, const VtxInfo &info) {
-        scc_sizes.async_visit(info.comp_id, [](auto pmap, const uint32_t &scc_id, uint32_t &count) {
+    vertex_map.for_all([&scc_sizes](const VertexId &vertex, const Info &info) {
+        scc_sizes.async_visit(info.comp_id, [](auto pmap, const VertexId &scc_id, uint64_t &count) {
             count++;
         });
     });
 
-    uint32_t local_max = 0;
+    uint64_t local_max = 0;
 
-    scc_sizes.for_all([&local_max](const uint32_t &scc_id, const uint32_t &size) {
+    scc_sizes.for_all([&local_max](const VertexId &scc_id, const uint64_t &size) {
         local_max = std::max(local_max, size);
     });
 
@@ -0,0 +1,142 @@
+#pragma once
+#include <ygm/comm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Per-rank mirrors of the high-degree vertices (hubs) of a CsrGraph.
+ *
+ * A hub's neighbors sit on every rank, so each message a phase sends along
+ * its edges converges on (or fans out from) the one rank that owns it.
+ * Every rank keeps the sorted list of hubs, chosen once by total degree, and
+ * for each hub the local endpoints of its edges. The DCSC phases use them
+ * vertex-cut style:
+ *
+ *   fan-out: a hub that has to visit all of its neighbors sends one message
+ *            per rank instead, and each rank visits its own endpoints
+ *   fan-in:  a rank sends a given pivot to a hub at most once per phase
+ *            (sent_fwd / sent_bwd)
+ *   marks:   the owner copies a hub's marks to every rank once per
+ *            iteration, so its edges are sheared from the other endpoint
+ *
+ * The hub list and endpoint lists are fixed after build(); endpoints whose
+ * edge has since been tombstoned are skipped when iterated.
+ */
+class HubMirrors {
+public:
+    static constexpr uint32_t kNoHub = -1;
+
+    /// Mirror every vertex with in + out degree >= min_degree (0 mirrors nothing). Collective.
+    template <typename Graph>
+    void build(ygm::comm& world, const Graph& graph, uint32_t min_degree) {
+        static std::vector<uint32_t>* p_hubs;
+        m_hubs.clear();
+        p_hubs = &m_hubs;
+
+        if (min_degree > 0) {
+            for (uint32_t l = 0; l < graph.num_local(); ++l) {
+                if (graph.present[l] && uint64_t(graph.in_degree(l)) + graph.out_degree(l) >= min_degree) {
+                    uint32_t vtx = graph.global_id(l);
+                    for (int rank = 0; rank < world.size(); ++rank) {
+                        world.async(rank, [](uint32_t vtx) { p_hubs->push_back(vtx); }, vtx);
+                    }
+                }
+            }
+        }
+        world.barrier();
+
+        // every rank numbers the hubs the same way
+        std::sort(m_hubs.begin(), m_hubs.end());
+
+        m_slots.clear();
+        m_filter.assign(m_hubs.empty() ? 0 : kFilterBits / 64, 0);
+        for (uint32_t slot = 0; slot < m_hubs.size(); ++slot) {
+            m_slots.emplace(m_hubs[slot], slot);
+            m_filter[filter_bit(m_hubs[slot]) / 64] |= uint64_t(1) << (filter_bit(m_hubs[slot]) % 64);
+        }
+
+        m_out_of.assign(m_hubs.size(), {});
+        m_into.assign(m_hubs.size(), {});
+        if (!m_hubs.empty()) {
+            for (uint32_t l = 0; l < graph.num_local(); ++l) {
+                graph.for_each_in(l, [&](uint32_t nbr) {
+                    uint32_t s = slot(nbr);
+                    if (s != kNoHub) {
+                        m_out_of[s].push_back(l);
+                    }
+                });
+                graph.for_each_out(l, [&](uint32_t nbr) {
+                    uint32_t s = slot(nbr);
+                    if (s != kNoHub) {
+                        m_into[s].push_back(l);
+                    }
+                });
+            }
+        }
+
+        active.assign(m_hubs.size(), 0);
+        mark_pred.assign(m_hubs.size(), 0);
+        mark_desc.assign(m_hubs.size(), 0);
+        sent_fwd.assign(m_hubs.size(), uint32_t(-1));
+        sent_bwd.assign(m_hubs.size(), uint32_t(-1));
+    }
+
+    bool empty() const { return m_hubs.empty(); }
+    uint32_t size() const { return m_hubs.size(); }
+
+    /// Global id of the hub in slot.
+    uint32_t hub(uint32_t slot) const { return m_hubs[slot]; }
+
+    /// Slot of vtx, or kNoHub if it is not a hub. Most ids are turned away by the filter without a lookup.
+    uint32_t slot(uint32_t vtx) const {
+        if (m_filter.empty() || !((m_filter[filter_bit(vtx) / 64] >> (filter_bit(vtx) % 64)) & 1)) {
+            return kNoHub;
+        }
+        auto it = m_slots.find(vtx);
+        return it == m_slots.end() ? kNoHub : it->second;
+    }
+
+    /// fn(lidx) for every local vertex that still has an edge from the hub in slot.
+    template <typename Graph, typename Function>
+    void for_each_out_of(const Graph& graph, uint32_t slot, Function fn) const {
+        for (uint32_t l : m_out_of[slot]) {
+            if (graph.has_in(l, m_hubs[slot])) {
+                fn(l);
+            }
+        }
+    }
+
+    /// fn(lidx) for every local vertex that still has an edge to the hub in slot.
+    template <typename Graph, typename Function>
+    void for_each_into(const Graph& graph, uint32_t slot, Function fn) const {
+        for (uint32_t l : m_into[slot]) {
+            if (graph.has_out(l, m_hubs[slot])) {
+                fn(l);
+            }
+        }
+    }
+
+    // Copies of the owners' state, by slot; refreshed by shear_edges.
+    std::vector<uint8_t> active;
+    std::vector<uint8_t> mark_pred;
+    std::vector<uint8_t> mark_desc;
+
+    // Pivot this rank last sent forward / backward to each hub; reset by prop_pivots.
+    std::vector<uint32_t> sent_fwd;
+    std::vector<uint32_t> sent_bwd;
+
+private:
+    static constexpr uint32_t kFilterLog = 16;
+    static constexpr uint32_t kFilterBits = uint32_t(1) << kFilterLog;
+
+    static uint32_t filter_bit(uint32_t vtx) { return uint32_t(vtx * 2654435761u) >> (32 - kFilterLog); }
+
+    std::vector<uint32_t> m_hubs;
+    std::unordered_map<uint32_t, uint32_t> m_slots;
+    std::vector<uint64_t> m_filter;
+    std::vector<std::vector<uint32_t>> m_out_of;
+    std::vector<std::vector<uint32_t>> m_into;
+};
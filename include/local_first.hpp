@@ -0,0 +1,251 @@
+#pragma once
+#include <ygm/comm.hpp>
+#include <ygm/container/map.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "csr_graph.hpp"
+#include "phase_stats.hpp"
+#include "pod_channel.hpp"
+
+/**
+ * @brief Local-first propagation of a visitor over a distributed graph.
+ *
+ * visit(vtx, args...) sends the visitor through YGM only when another rank
+ * owns vtx. Visits to vertices this rank owns go onto a worklist that
+ * drain() applies in place, so a traversal runs through the local part of
+ * the graph without serializing anything, and only cross-rank frontier
+ * vertices become messages.
+ *
+ * A visitor pushes its own follow-up visits through the same frontier and
+ * calls drain() before returning. drain() does nothing when it is already
+ * running further up the stack, so the worklist is processed by exactly one
+ * loop whether the visitor was started by a local sweep or by a message.
+ *
+ * Visits are only queued, never applied from inside visit(). This keeps a
+ * caller that is walking a neighbor list from having that list changed
+ * under it by the visits it makes.
+ *
+ * Remote visits travel as packed (target, args...) records over a
+ * PodChannel, which the outermost drain() flushes, so Args must be
+ * trivially copyable. On arrival the visitor is applied right away, as
+ * async_visit would.
+ */
+template <typename Graph, typename Visitor, typename... Args>
+class LocalFirstFrontier;
+
+namespace detail {
+
+template <typename Derived, typename Key, typename... Args>
+class LocalWorklist {
+public:
+    void drain() {
+        if (m_draining) {
+            return;
+        }
+        m_draining = true;
+        while (!m_work.empty()) {
+            auto item = std::move(m_work.back());
+            m_work.pop_back();
+            std::apply([this](const Key& key, const Args&... args) {
+                static_cast<Derived*>(this)->apply_local(key, args...);
+            }, item);
+        }
+        m_draining = false;
+        static_cast<Derived*>(this)->flush_remote();
+    }
+
+    /// Visits applied in place / sent as messages since construction.
+    size_t local_visits() const { return m_local_visits; }
+    size_t remote_visits() const { return m_remote_visits; }
+
+protected:
+    void push(const Key& key, const Args&... args) {
+        m_work.emplace_back(key, args...);
+        ++m_local_visits;
+    }
+
+    std::vector<std::tuple<Key, Args...>> m_work;
+    bool m_draining = false;
+    size_t m_local_visits = 0;
+    size_t m_remote_visits = 0;
+};
+
+} // namespace detail
+
+/// ygm::container::map flavour: local visits go through map::local_visit.
+template <typename Key, typename Value, typename Visitor, typename... Args>
+class LocalFirstFrontier<ygm::container::map<Key, Value>, Visitor, Args...>
+    : public detail::LocalWorklist<LocalFirstFrontier<ygm::container::map<Key, Value>, Visitor, Args...>, Key, Args...> {
+public:
+    using map_type = ygm::container::map<Key, Value>;
+
+    explicit LocalFirstFrontier(map_type& vertex_map) : m_map(vertex_map), m_channel(vertex_map.comm()) {
+        p_self() = this;
+    }
+
+    void visit(const Key& key, const Args&... args) {
+        if (is_local(key)) {
+            this->push(key, args...);
+        } else {
+            send(key, args...);
+        }
+    }
+
+    bool is_local(const Key& key) const { return m_map.is_mine(key); }
+
+    /// Send the visitor to the rank that owns key, bypassing the worklist.
+    void send(const Key& key, const Args&... args) {
+        m_channel.send(m_map.partitioner.owner(key), key, args...);
+        count_message(key, args...);
+        ++this->m_remote_visits;
+    }
+
+    void apply_local(const Key& key, const Args&... args) {
+        Visitor fn;
+        m_map.local_visit(key, fn, args...);
+    }
+
+    void flush_remote() { m_channel.flush(); }
+
+private:
+    static LocalFirstFrontier*& p_self() {
+        static LocalFirstFrontier* self = nullptr;
+        return self;
+    }
+
+    struct deliver {
+        void operator()(const Key& key, const Args&... args) const { p_self()->apply_local(key, args...); }
+    };
+
+    map_type& m_map;
+    PodChannel<deliver, Key, Args...> m_channel;
+};
+
+/// CsrGraph flavour: visitors are called as Visitor()(local_index, args...).
+template <typename Visitor, typename... Args>
+class LocalFirstFrontier<CsrGraph, Visitor, Args...>
+    : public detail::LocalWorklist<LocalFirstFrontier<CsrGraph, Visitor, Args...>, uint32_t, Args...> {
+public:
+    explicit LocalFirstFrontier(CsrGraph& graph) : m_graph(graph), m_channel(graph.comm()) {}
+
+    void visit(uint32_t vtx, const Args&... args) {
+        if (is_local(vtx)) {
+            this->push(m_graph.local_index(vtx), args...);
+        } else {
+            send(vtx, args...);
+        }
+    }
+
+    bool is_local(uint32_t vtx) const { return m_graph.owner(vtx) == m_graph.comm().rank(); }
+
+    /// Send the visitor to the rank that owns vtx, bypassing the worklist.
+    void send(uint32_t vtx, const Args&... args) {
+        m_channel.send(m_graph.owner(vtx), m_graph.local_index(vtx), args...);
+        count_message(vtx, args...);
+        ++this->m_remote_visits;
+    }
+
+    void apply_local(uint32_t lidx, const Args&... args) {
+        Visitor()(lidx, args...);
+    }
+
+    void flush_remote() { m_channel.flush(); }
+
+private:
+    CsrGraph& m_graph;
+    PodChannel<Visitor, uint32_t, Args...> m_channel;
+};
+
+/**
+ * @brief LocalFirstFrontier for min-label propagation that combines and filters remote visits.
+ *
+ * A remote visit(vtx, label) is not sent right away. Per target vertex only
+ * the smallest pending label is kept, and the batch goes out when the
+ * outermost drain() finishes. A label that is not below the last one this
+ * rank already sent to vtx is dropped, since the target has that label or a
+ * smaller one already and would ignore it. Local visits are unchanged.
+ *
+ * Between hold() and release() drain() keeps collecting instead of sending
+ * (up to kMaxPending targets), so a sweep over many local vertices sends at
+ * most one label per remote target. Only valid for visitors that keep the
+ * minimum of the labels they receive. Labels are vertex ids of the graph.
+ */
+template <typename Graph, typename Visitor>
+class MinCombiningFrontier : public LocalFirstFrontier<Graph, Visitor, vertex_id_t<Graph>> {
+    using base = LocalFirstFrontier<Graph, Visitor, vertex_id_t<Graph>>;
+    using vertex_type = vertex_id_t<Graph>;
+
+public:
+    static constexpr size_t kMaxPending = size_t(1) << 16;
+
+    explicit MinCombiningFrontier(Graph& graph) : base(graph) {}
+
+    void visit(vertex_type vtx, vertex_type label) {
+        if (this->is_local(vtx)) {
+            base::visit(vtx, label);
+            return;
+        }
+
+        auto sent = m_sent.find(vtx);
+        if (sent != m_sent.end() && sent->second <= label) {
+            ++m_filtered;
+            return;
+        }
+
+        auto [pending, fresh] = m_pending.try_emplace(vtx, label);
+        if (!fresh) {
+            ++m_combined;
+            pending->second = std::min(pending->second, label);
+        }
+    }
+
+    void drain() {
+        if (this->m_draining) {
+            return;
+        }
+        base::drain();
+        if (!m_held || m_pending.size() >= kMaxPending) {
+            flush();
+        }
+    }
+
+    void hold() { m_held = true; }
+    void release() {
+        m_held = false;
+        flush();
+    }
+
+    /// Remote visits merged into a pending one / dropped as already sent.
+    size_t combined_visits() const { return m_combined; }
+    size_t filtered_visits() const { return m_filtered; }
+
+private:
+    void flush() {
+        // sending can run handlers that queue new labels, so send from a detached batch
+        std::unordered_map<vertex_type, vertex_type> batch;
+        batch.swap(m_pending);
+        for (const auto& [vtx, label] : batch) {
+            auto [sent, fresh] = m_sent.try_emplace(vtx, label);
+            if (!fresh) {
+                if (sent->second <= label) {
+                    continue;
+                }
+                sent->second = label;
+            }
+            this->send(vtx, label);
+        }
+        this->flush_remote();
+    }
+
+    std::unordered_map<vertex_type, vertex_type> m_pending;
+    std::unordered_map<vertex_type, vertex_type> m_sent;
+    bool m_held = false;
+    size_t m_combined = 0;
+    size_t m_filtered = 0;
+};
@@ -0,0 +1,180 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+/**
+ * @brief Per-rank pool of fixed-size blocks for the nodes of node-based neighbor lists.
+ *
+ * Building a graph inserts its edges one node at a time and shear and trim
+ * erase them the same way, so a node-based adjacency would make a global
+ * allocator call per edge and leave the heap fragmented. NodePool carves the
+ * blocks of one size out of kChunkBytes chunks aligned to their own size,
+ * which lets a block find its chunk by masking its address:
+ *
+ *   - allocate() takes a freed block of a chunk that has one, else the next
+ *     untouched block, else a new chunk,
+ *   - deallocate() returns the block to its chunk, and a chunk whose last
+ *     block is returned goes back to the system (one empty chunk is kept
+ *     so a list hovering at a chunk boundary does not thrash).
+ *
+ * The memory of erased edges is therefore given back as whole chunks once
+ * the vertices that own them are done. Pools are shared by every container
+ * of a rank; like the map graph itself they are single-threaded.
+ */
+class NodePool {
+public:
+    static constexpr size_t kChunkBytes = size_t(1) << 16;
+
+    NodePool(size_t block_bytes, size_t align)
+        : m_block(round_up(std::max(block_bytes, sizeof(void*)), std::max(align, alignof(void*)))),
+          m_first(round_up(sizeof(Chunk), std::max(align, alignof(void*)))),
+          m_capacity(uint32_t((kChunkBytes - m_first) / m_block)) {}
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    void* allocate() {
+        Chunk* chunk = m_partial;
+        if (!chunk) {
+            chunk = new_chunk();
+        }
+
+        void* block;
+        if (chunk->free) {
+            block = chunk->free;
+            chunk->free = *static_cast<void**>(block);
+        } else {
+            block = reinterpret_cast<unsigned char*>(chunk) + m_first + size_t(chunk->bumped++) * m_block;
+        }
+        if (++chunk->live == m_capacity) {
+            unlink(chunk);
+        }
+        return block;
+    }
+
+    void deallocate(void* block) {
+        Chunk* chunk = chunk_of(block);
+        if (chunk->live-- == m_capacity) {
+            link(chunk);
+        }
+        *static_cast<void**>(block) = chunk->free;
+        chunk->free = block;
+
+        if (chunk->live == 0) {
+            unlink(chunk);
+            if (m_spare) {
+                std::free(m_spare);
+                --m_chunks;
+            }
+            m_spare = chunk;
+        }
+    }
+
+    /// Chunks held, the spare included.
+    size_t chunks() const { return m_chunks; }
+    size_t reserved_bytes() const { return m_chunks * kChunkBytes; }
+
+    /// The rank's pool for blocks of Bytes bytes aligned to Align; never destroyed, so containers outliving main stay valid.
+    template <size_t Bytes, size_t Align>
+    static NodePool& shared() {
+        static NodePool* pool = new NodePool(Bytes, Align);
+        return *pool;
+    }
+
+private:
+    struct Chunk {
+        Chunk* prev;       // chunks with a free block
+        Chunk* next;
+        void* free;        // blocks returned to this chunk
+        uint32_t live;     // blocks handed out
+        uint32_t bumped;   // blocks ever taken from the untouched tail
+    };
+
+    static size_t round_up(size_t bytes, size_t align) { return (bytes + align - 1) / align * align; }
+
+    static Chunk* chunk_of(void* block) {
+        return reinterpret_cast<Chunk*>(reinterpret_cast<uintptr_t>(block) & ~uintptr_t(kChunkBytes - 1));
+    }
+
+    Chunk* new_chunk() {
+        Chunk* chunk = m_spare;
+        m_spare = nullptr;
+        if (!chunk) {
+            chunk = static_cast<Chunk*>(std::aligned_alloc(kChunkBytes, kChunkBytes));
+            if (!chunk) {
+                throw std::bad_alloc();
+            }
+            ++m_chunks;
+        }
+        *chunk = Chunk{nullptr, nullptr, nullptr, 0, 0};
+        link(chunk);
+        return chunk;
+    }
+
+    void link(Chunk* chunk) {
+        chunk->prev = nullptr;
+        chunk->next = m_partial;
+        if (m_partial) {
+            m_partial->prev = chunk;
+        }
+        m_partial = chunk;
+    }
+
+    void unlink(Chunk* chunk) {
+        if (chunk->prev) {
+            chunk->prev->next = chunk->next;
+        } else {
+            m_partial = chunk->next;
+        }
+        if (chunk->next) {
+            chunk->next->prev = chunk->prev;
+        }
+    }
+
+    size_t m_block;          // bytes per block
+    size_t m_first;          // offset of the first block, past the chunk header
+    uint32_t m_capacity;     // blocks per chunk
+    Chunk* m_partial = nullptr;
+    Chunk* m_spare = nullptr;
+    size_t m_chunks = 0;
+};
+
+/**
+ * @brief Allocator that serves single objects from the NodePool of their size.
+ *
+ * Node-based containers allocate one node at a time; anything larger, such
+ * as a hash table's bucket array, goes to std::allocator.
+ */
+template <typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    PoolAllocator() = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        if (n == 1) {
+            return static_cast<T*>(pool().allocate());
+        }
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) {
+        if (n == 1) {
+            pool().deallocate(p);
+        } else {
+            std::allocator<T>().deallocate(p, n);
+        }
+    }
+
+    static NodePool& pool() { return NodePool::shared<sizeof(T), alignof(T)>(); }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>&) const { return true; }
+};
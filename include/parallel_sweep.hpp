@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "csr_graph.hpp"
+
+/**
+ * @brief OpenMP helpers for the rank-local sweeps over a CsrGraph.
+ *
+ * YGM is driven from one thread per rank. Handlers and every async() run on
+ * that thread, so the threads only do the local part of a sweep:
+ *
+ *   select_active:         evaluate a per-vertex predicate in parallel and
+ *                          hand back the vertices that need serial work
+ *   for_all_active_buffered: let each thread fill its own outbox with the
+ *                          messages a block of vertices produces, then
+ *                          send the outboxes in thread order
+ *
+ * Both visit vertices in the same order as the serial sweep. Without
+ * OpenMP (or with OMP_NUM_THREADS=1) they are plain loops. The vertex-map
+ * kernels stay serial, because ygm::container::map can only be walked with
+ * local_for_all.
+ */
+
+/// Threads a sweep can use: 1 without OpenMP.
+inline int sweep_threads() {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+inline int sweep_thread() {
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+/// Vertices per block of for_all_active_buffered; bounds the size of the outboxes.
+constexpr size_t kSweepBlock = size_t(1) << 14;
+
+/**
+ * @brief Local indices of the active vertices in `list` (every local slot if null) for which pred(lidx) holds.
+ *
+ * pred runs on the OpenMP threads, so it may read the graph and write the
+ * state of lidx itself, but must not send or touch other vertices. The
+ * result keeps list order. If `visited` is given it receives the number of
+ * active vertices pred was called on.
+ */
+template <typename Predicate>
+inline std::vector<uint32_t> select_active(CsrGraph& graph, const std::vector<uint32_t>* list, Predicate pred,
+                                           size_t* visited = nullptr) {
+    const int64_t n = list ? list->size() : graph.num_local();
+    std::vector<std::vector<uint32_t>> parts(sweep_threads());
+    size_t calls = 0;
+
+    #pragma omp parallel reduction(+:calls)
+    {
+        std::vector<uint32_t>& part = parts[sweep_thread()];
+
+        // static schedule: thread t gets the t-th contiguous chunk, so the parts concatenate in order
+        #pragma omp for schedule(static)
+        for (int64_t i = 0; i < n; ++i) {
+            uint32_t l = list ? (*list)[i] : uint32_t(i);
+            if (graph.active[l]) {
+                ++calls;
+                if (pred(l)) {
+                    part.push_back(l);
+                }
+            }
+        }
+    }
+
+    if (visited) {
+        *visited = calls;
+    }
+
+    if (parts.size() == 1) {
+        return std::move(parts[0]);
+    }
+
+    size_t total = 0;
+    for (const auto& part : parts) {
+        total += part.size();
+    }
+    std::vector<uint32_t> selected;
+    selected.reserve(total);
+    for (const auto& part : parts) {
+        selected.insert(selected.end(), part.begin(), part.end());
+    }
+    return selected;
+}
+
+/// select_active over the ActiveList when one has been built.
+template <typename Predicate>
+inline std::vector<uint32_t> select_active(CsrGraph& graph, const ActiveList* active, Predicate pred,
+                                           size_t* visited = nullptr) {
+    return select_active(graph, active == nullptr || active->all ? nullptr : &active->vertices, pred, visited);
+}
+
+/**
+ * @brief Sweep the active vertices, produce(lidx, outbox) on the threads and send(message) on the YGM thread.
+ *
+ * produce has the same restrictions as a select_active predicate and pushes
+ * its messages onto the vector it is given. The outboxes of each block of
+ * kSweepBlock vertices are sent in vertex order before the next block
+ * starts, so at most one block of messages is held at a time.
+ */
+template <typename Message, typename Produce, typename Send>
+inline void for_all_active_buffered(CsrGraph& graph, const ActiveList* active, Produce produce, Send send) {
+    const std::vector<uint32_t>* list = active == nullptr || active->all ? nullptr : &active->vertices;
+    const size_t n = list ? list->size() : graph.num_local();
+    std::vector<std::vector<Message>> outboxes(sweep_threads());
+
+    for (size_t first = 0; first < n; first += kSweepBlock) {
+        const int64_t last = std::min(n, first + kSweepBlock);
+
+        #pragma omp parallel
+        {
+            std::vector<Message>& outbox = outboxes[sweep_thread()];
+
+            #pragma omp for schedule(static)
+            for (int64_t i = first; i < last; ++i) {
+                uint32_t l = list ? (*list)[i] : uint32_t(i);
+                if (graph.active[l]) {
+                    produce(l, outbox);
+                }
+            }
+        }
+
+        for (auto& outbox : outboxes) {
+            for (const Message& message : outbox) {
+                send(message);
+            }
+            outbox.clear();
+        }
+    }
+}
@@ -0,0 +1,191 @@
+#pragma once
+#include <ygm/comm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "csr_graph.hpp"
+#include "graph_util.hpp"
+#include "pod_channel.hpp"
+
+/**
+ * @brief Per-iteration, per-phase instrumentation of the DCSC loop.
+ *
+ * The kernels report every message they send through count_message() and
+ * end with timed_barrier() instead of world.barrier(); these only bump
+ * rank-local counters, so they cost nothing measurable when nobody reads
+ * them. PhaseRecorder::run() wraps one phase, snapshots the counters and
+ * reduces wall time, messages, payload bytes, barrier time and the active
+ * vertex count to min / max / mean over ranks.
+ *
+ * Bytes are the application payload (key plus visitor arguments); YGM's own
+ * headers and packing are not included. Barrier time includes the messages
+ * YGM delivers while waiting there.
+ */
+struct PhaseCounters {
+    uint64_t messages = 0;
+    uint64_t bytes = 0;
+    double barrier_seconds = 0;
+};
+
+inline PhaseCounters& phase_counters() {
+    static PhaseCounters counters;
+    return counters;
+}
+
+/// Record one message carrying args as payload.
+template <typename... Args>
+inline void count_message(const Args&... args) {
+    PhaseCounters& counters = phase_counters();
+    ++counters.messages;
+    counters.bytes += (sizeof(Args) + ... + 0);
+}
+
+inline double wall_seconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// world.barrier(), with the time spent waiting charged to the current phase. Flushes the PodChannels first.
+inline void timed_barrier(ygm::comm &world) {
+    double start = wall_seconds();
+    flush_pod_channels();
+    world.barrier();
+    phase_counters().barrier_seconds += wall_seconds() - start;
+}
+
+class PhaseRecorder {
+public:
+    static constexpr size_t kMetrics = 5;
+
+    struct Record {
+        uint64_t iteration;
+        std::string phase;
+        double min[kMetrics];
+        double max[kMetrics];
+        double mean[kMetrics];
+    };
+
+    PhaseRecorder(ygm::comm &world, bool enabled) : m_world(world), m_enabled(enabled) {}
+
+    bool enabled() const { return m_enabled; }
+    const std::vector<Record>& records() const { return m_records; }
+
+    /// Run fn() as phase `phase` of `iteration` and record it (collective when enabled).
+    template <typename Graph, typename Function>
+    void run(uint64_t iteration, const std::string& phase, Graph& graph, Function fn) {
+        if (!m_enabled) {
+            fn();
+            return;
+        }
+
+        phase_counters() = PhaseCounters();
+        double start = wall_seconds();
+        fn();
+        double elapsed = wall_seconds() - start;
+
+        const PhaseCounters& counters = phase_counters();
+        double local[kMetrics] = {elapsed, double(counters.messages), double(counters.bytes), counters.barrier_seconds,
+                                  double(local_active_count(graph))};
+
+        // one collective: [min..., max..., sum...]
+        std::vector<double> reduced(3 * kMetrics);
+        for (size_t m = 0; m < kMetrics; ++m) {
+            reduced[m] = reduced[kMetrics + m] = reduced[2 * kMetrics + m] = local[m];
+        }
+        reduced = m_world.all_reduce(reduced, [](const std::vector<double>& a, const std::vector<double>& b) {
+            std::vector<double> r(a.size());
+            for (size_t m = 0; m < kMetrics; ++m) {
+                r[m] = std::min(a[m], b[m]);
+                r[kMetrics + m] = std::max(a[kMetrics + m], b[kMetrics + m]);
+                r[2 * kMetrics + m] = a[2 * kMetrics + m] + b[2 * kMetrics + m];
+            }
+            return r;
+        });
+
+        Record record{iteration, phase, {}, {}, {}};
+        for (size_t m = 0; m < kMetrics; ++m) {
+            record.min[m] = reduced[m];
+            record.max[m] = reduced[kMetrics + m];
+            record.mean[m] = reduced[2 * kMetrics + m] / m_world.size();
+        }
+        m_records.push_back(record);
+    }
+
+    /// Per-phase totals of the slowest rank's wall and barrier time, on rank 0.
+    void print_summary() const {
+        if (!m_enabled || !m_world.rank0()) {
+            return;
+        }
+
+        std::vector<std::string> order;
+        std::map<std::string, std::pair<double, double>> totals;
+        for (const Record& r : m_records) {
+            if (!totals.count(r.phase)) {
+                order.push_back(r.phase);
+            }
+            totals[r.phase].first += r.max[0];
+            totals[r.phase].second += r.max[3];
+        }
+
+        std::cout << "Phase time (slowest rank, summed over iterations):" << std::endl;
+        for (const std::string& phase : order) {
+            std::cout << "  " << phase << ": " << totals[phase].first << " s, " << totals[phase].second
+                      << " s in barriers" << std::endl;
+        }
+    }
+
+    /// Write the records from rank 0 as JSON if path ends in ".json", CSV otherwise.
+    void write(const std::string& path) const {
+        if (!m_world.rank0()) {
+            return;
+        }
+
+        std::ofstream out(path);
+        if (!out) {
+            throw std::runtime_error("cannot write phase stats to " + path);
+        }
+        out.precision(9);
+
+        static const char* names[kMetrics] = {"wall_seconds", "messages", "bytes", "barrier_seconds", "active"};
+        bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+
+        if (json) {
+            out << "[\n";
+            for (size_t i = 0; i < m_records.size(); ++i) {
+                const Record& r = m_records[i];
+                out << "  {\"iteration\": " << r.iteration << ", \"phase\": \"" << r.phase << "\", \"ranks\": " << m_world.size();
+                for (size_t m = 0; m < kMetrics; ++m) {
+                    out << ", \"" << names[m] << "\": {\"min\": " << r.min[m] << ", \"max\": " << r.max[m]
+                        << ", \"mean\": " << r.mean[m] << "}";
+                }
+                out << "}" << (i + 1 < m_records.size() ? "," : "") << "\n";
+            }
+            out << "]\n";
+            return;
+        }
+
+        out << "iteration,phase,ranks";
+        for (size_t m = 0; m < kMetrics; ++m) {
+            out << "," << names[m] << "_min," << names[m] << "_max," << names[m] << "_mean";
+        }
+        out << "\n";
+        for (const Record& r : m_records) {
+            out << r.iteration << "," << r.phase << "," << m_world.size();
+            for (size_t m = 0; m < kMetrics; ++m) {
+                out << "," << r.min[m] << "," << r.max[m] << "," << r.mean[m];
+            }
+            out << "\n";
+        }
+    }
+
+private:
+    ygm::comm& m_world;
+    bool m_enabled;
+    std::vector<Record> m_records;
+};
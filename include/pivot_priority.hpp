@@ -0,0 +1,78 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <string>
+
+#include "fpp_vertex_permuter.hpp"
+
+/**
+ * @brief Pivot priorities for init_wcc_pivots: the vertex with the smallest priority in its WCC becomes the pivot.
+ *
+ * Priorities must be distinct across vertices, or a WCC could end up with
+ * two pivots, and every vertex must be able to compute its own from local
+ * state, so that choosing the pivots stays a single min-label propagation.
+ *
+ *   - random: the vertex's image under the FppPermuter seeded by the
+ *     iteration, as before.
+ *   - degree: a degree class in the high bits, the permuted offset
+ *     (perm(vtx) - min) below it as the tiebreaker. The class is
+ *     bit_width(in) + bit_width(out) of the live degrees, about
+ *     log2(in * out), inverted so that larger classes win, and clamped to
+ *     the bits the id range leaves free (at most 6, one always kept clear
+ *     so no priority is the -1 "unset" value). With no free bits it is the
+ *     random policy.
+ *
+ * Only the random priority of a neighbor follows from its id, so the
+ * any_below() preemption of the sweep is used only when the ids alone
+ * decide (uses_ids_only()).
+ */
+enum class PivotPolicy { random, degree };
+
+inline bool parse_pivot_policy(const std::string& name, PivotPolicy& policy) {
+    if (name == "random") {
+        policy = PivotPolicy::random;
+    } else if (name == "degree") {
+        policy = PivotPolicy::degree;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+template <typename Id = uint32_t>
+class BasicPivotPriority {
+public:
+    static constexpr unsigned kMaxClassBits = 6;
+
+    BasicPivotPriority(Id min, Id max, uint64_t seed, PivotPolicy policy) : m_perm(min, max, seed) {
+        constexpr unsigned kBits = 8 * sizeof(Id);
+        m_shift = std::bit_width(Id(m_perm.max_id() - m_perm.min_id()));
+        if (policy == PivotPolicy::degree && m_shift + 1 < kBits) {
+            m_class_bits = std::min(kMaxClassBits, kBits - 1 - m_shift);
+        }
+        m_max_class = (uint64_t(1) << m_class_bits) - 1;
+    }
+
+    /// Priority of vtx with the given live in- and out-degree.
+    Id operator()(Id vtx, uint64_t in_degree, uint64_t out_degree) const {
+        if (m_class_bits == 0) {
+            return m_perm(vtx);
+        }
+        uint64_t cls = std::min<uint64_t>(std::bit_width(in_degree) + std::bit_width(out_degree), m_max_class);
+        return Id((m_max_class - cls) << m_shift) | Id(m_perm(vtx) - m_perm.min_id());
+    }
+
+    /// Whether the priorities are the permuted ids, so permuter().any_below() can rule on neighbors.
+    bool uses_ids_only() const { return m_class_bits == 0; }
+
+    const BasicFppPermuter<Id>& permuter() const { return m_perm; }
+
+private:
+    BasicFppPermuter<Id> m_perm;
+    unsigned m_shift = 0;        // bits of the permuted offset
+    unsigned m_class_bits = 0;   // bits of the degree class above it
+    uint64_t m_max_class = 0;
+};
+
+using PivotPriority = BasicPivotPriority<uint32_t>;
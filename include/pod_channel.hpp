@@ -0,0 +1,131 @@
+#pragma once
+#include <ygm/comm.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <cereal/types/vector.hpp>
+
+/**
+ * @brief Packed per-destination batches of fixed-size messages for the hot DCSC visitors.
+ *
+ * The kernels' messages are a vertex id or two and a flag. Sent one by one
+ * through comm::async, each of them is a cereal-serialized argument pack
+ * behind its own handler dispatch. PodChannel<Handler, Fields...> instead
+ * copies the trivially copyable fields of a message back to back into a
+ * byte buffer per destination rank and ships a buffer as a single async
+ * once it holds kBatchBytes. The receiving rank decodes the records in one
+ * loop and calls Handler()(fields...) on each; the handler is fixed by the
+ * channel type, so nothing about it travels with the records.
+ *
+ * Buffered records are not visible to YGM, so they must be flushed before
+ * the ranks wait for quiescence. Three points cover the kernels:
+ *
+ *   - LocalFirstFrontier flushes its channel when its outermost drain() ends,
+ *   - every received batch flushes all live channels after its last record,
+ *     which sends what its handlers produced,
+ *   - timed_barrier() flushes all live channels before it waits.
+ */
+class PodChannelBase {
+public:
+    PodChannelBase(const PodChannelBase&) = delete;
+    PodChannelBase& operator=(const PodChannelBase&) = delete;
+
+    virtual ~PodChannelBase() {
+        auto& channels = live();
+        channels.erase(std::find(channels.begin(), channels.end(), this));
+    }
+
+    /// Send every partial batch.
+    virtual void flush() = 0;
+
+    /// Flush every channel alive on this rank.
+    static void flush_all() {
+        // a flush can run handlers that open channels of their own, so walk by index
+        auto& channels = live();
+        for (size_t i = 0; i < channels.size(); ++i) {
+            channels[i]->flush();
+        }
+    }
+
+protected:
+    PodChannelBase() { live().push_back(this); }
+
+private:
+    static std::vector<PodChannelBase*>& live() {
+        static std::vector<PodChannelBase*> channels;
+        return channels;
+    }
+};
+
+inline void flush_pod_channels() { PodChannelBase::flush_all(); }
+
+template <typename Handler, typename... Fields>
+class PodChannel : public PodChannelBase {
+    static_assert((std::is_trivially_copyable_v<Fields> && ...), "POD message fields");
+
+public:
+    static constexpr size_t kRecordBytes = (sizeof(Fields) + ... + 0);
+    /// Bytes collected per destination before they are sent.
+    static constexpr size_t kBatchBytes = size_t(1) << 14;
+
+    explicit PodChannel(ygm::comm& world) : m_world(world), m_buffers(world.size()) {}
+
+    ~PodChannel() override = default;
+
+    void send(int dest, const Fields&... fields) {
+        unsigned char record[kRecordBytes];
+        unsigned char* out = record;
+        ((std::memcpy(out, &fields, sizeof(Fields)), out += sizeof(Fields)), ...);
+
+        std::vector<unsigned char>& buffer = m_buffers[dest];
+        if (buffer.capacity() == 0) {
+            buffer.reserve(kBatchBytes + kRecordBytes);
+        }
+        buffer.insert(buffer.end(), record, record + kRecordBytes);
+        if (buffer.size() >= kBatchBytes) {
+            flush(dest);
+        }
+    }
+
+    void flush() override {
+        for (int dest = 0; dest < m_world.size(); ++dest) {
+            flush(dest);
+        }
+    }
+
+private:
+    void flush(int dest) {
+        if (m_buffers[dest].empty()) {
+            return;
+        }
+
+        // sending can run handlers that send on this channel again, so ship a detached batch
+        std::vector<unsigned char> batch;
+        batch.swap(m_buffers[dest]);
+        m_world.async(dest, [](const std::vector<unsigned char>& packed) {
+            for (size_t at = 0; at + kRecordBytes <= packed.size(); at += kRecordBytes) {
+                std::apply(Handler(), decode(packed.data() + at));
+            }
+            flush_pod_channels();
+        }, batch);
+
+        if (m_buffers[dest].empty()) {
+            batch.clear();
+            m_buffers[dest].swap(batch);
+        }
+    }
+
+    static std::tuple<Fields...> decode(const unsigned char* in) {
+        std::tuple<Fields...> fields;
+        std::apply([&in](Fields&... field) { ((std::memcpy(&field, in, sizeof(Fields)), in += sizeof(Fields)), ...); }, fields);
+        return fields;
+    }
+
+    ygm::comm& m_world;
+    std::vector<std::vector<unsigned char>> m_buffers;
+};
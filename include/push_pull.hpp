@@ -0,0 +1,196 @@
+#pragma once
+#include <ygm/comm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <cereal/types/vector.hpp>
+
+#include "phase_stats.hpp"
+
+/**
+ * @brief Building blocks of the direction-optimizing (push/pull) reach in prop_pivots_push_pull.
+ *
+ * The forward and backward reach advance one level per round. A direction
+ * pushes its frontier along its edges, one visit per edge, while the
+ * frontier is small. It pulls once the frontier's edges outnumber the
+ * edges left to the unmarked vertices over kAlpha (Beamer et al.): the
+ * ranks OR their marks into a bitmap over [min, max] replicated on every
+ * rank, and each unmarked active vertex looks its reverse neighbors up in
+ * it, which sends nothing. It goes back to pushing once the frontier falls
+ * under 1/kBeta of the active vertices. Pulling is also only chosen while
+ * the frontier has more edges than the bitmap, copied to every rank, has
+ * words, so a sparse id range never pays more for the bitmap than the
+ * visits it saves.
+ *
+ * A vertex that pulls its mark learns that some neighbor is marked, not
+ * the pivot's marker. The pivots therefore enter their markers in a
+ * PivotRegistry under their pivot label when the first pull round starts,
+ * and the vertices that end up marked both ways without a marker look it
+ * up there.
+ */
+template <typename VertexId>
+struct ReachDirection {
+    static constexpr uint64_t kAlpha = 14;
+    static constexpr uint64_t kBeta = 24;
+
+    std::vector<VertexId> frontier;   // marked in the previous round, edges not walked yet
+    std::vector<VertexId> next;       // marked in this round
+    uint64_t next_edges = 0;          // edges leaving next in this direction
+    uint64_t unmarked_edges = 0;      // reverse edges of the unmarked active vertices, the ones a pull checks
+    bool pull = false;
+
+    /// Record a vertex marked this round with `along` edges in this direction and `against` in the other.
+    void marked(VertexId vtx, uint64_t along, uint64_t against) {
+        next.push_back(vtx);
+        next_edges += along;
+        unmarked_edges -= against;
+    }
+};
+
+/**
+ * @brief Collectively start the next round: move every next into its frontier and pick each direction's mode.
+ *
+ * active_vertices is the global count of active vertices and bitmap_words
+ * the size of one replicated bitmap. Returns false once both frontiers are
+ * empty everywhere.
+ */
+template <typename VertexId>
+inline bool next_reach_round(ygm::comm& world, ReachDirection<VertexId>* dirs, uint64_t active_vertices, uint64_t bitmap_words) {
+    std::vector<uint64_t> counts = {dirs[0].next.size(), dirs[0].next_edges, dirs[0].unmarked_edges,
+                                    dirs[1].next.size(), dirs[1].next_edges, dirs[1].unmarked_edges};
+    counts = world.all_reduce(counts, [](const std::vector<uint64_t>& a, const std::vector<uint64_t>& b) {
+        std::vector<uint64_t> sum(a);
+        for (size_t i = 0; i < sum.size(); ++i) {
+            sum[i] += b[i];
+        }
+        return sum;
+    });
+
+    for (int d = 0; d < 2; ++d) {
+        uint64_t vertices = counts[3 * d];
+        uint64_t edges = counts[3 * d + 1];
+        uint64_t unmarked = counts[3 * d + 2];
+
+        ReachDirection<VertexId>& dir = dirs[d];
+        if (dir.pull) {
+            dir.pull = vertices >= active_vertices / ReachDirection<VertexId>::kBeta;
+        } else {
+            dir.pull = edges > unmarked / ReachDirection<VertexId>::kAlpha && edges > bitmap_words * world.size();
+        }
+        dir.frontier.clear();
+        dir.frontier.swap(dir.next);
+        dir.next_edges = 0;
+    }
+
+    return counts[0] + counts[3] > 0;
+}
+
+/// Per-direction mark bitmaps over [min, max], OR-reduced over the ranks.
+template <typename VertexId>
+class ReachBitmaps {
+public:
+    ReachBitmaps(VertexId min, VertexId max) : m_min(min), m_words(max < min ? 0 : (uint64_t(max - min) >> 6) + 1) {}
+
+    uint64_t words() const { return m_words; }
+
+    /// Empty the bitmaps of the pulling directions and drop the others.
+    void reset(const ReachDirection<VertexId>* dirs) {
+        for (int d = 0; d < 2; ++d) {
+            m_bits[d].assign(dirs[d].pull ? m_words : 0, 0);
+        }
+    }
+
+    void set(int d, VertexId vtx) {
+        uint64_t bit = uint64_t(vtx - m_min);
+        m_bits[d][bit >> 6] |= uint64_t(1) << (bit & 63);
+    }
+
+    bool test(int d, VertexId vtx) const {
+        if (vtx < m_min) {
+            return false;
+        }
+        uint64_t bit = uint64_t(vtx - m_min);
+        return (bit >> 6) < m_bits[d].size() && (m_bits[d][bit >> 6] >> (bit & 63)) & 1;
+    }
+
+    /// Collectively OR the bitmaps in use across ranks, in one reduction.
+    void reduce(ygm::comm& world) {
+        std::vector<uint64_t> both(m_bits[0]);
+        both.insert(both.end(), m_bits[1].begin(), m_bits[1].end());
+        both = world.all_reduce(both, [](const std::vector<uint64_t>& a, const std::vector<uint64_t>& b) {
+            std::vector<uint64_t> merged(a);
+            for (size_t i = 0; i < merged.size(); ++i) {
+                merged[i] |= b[i];
+            }
+            return merged;
+        });
+        std::copy(both.begin(), both.begin() + m_bits[0].size(), m_bits[0].begin());
+        std::copy(both.begin() + m_bits[0].size(), both.end(), m_bits[1].begin());
+    }
+
+private:
+    VertexId m_min;
+    uint64_t m_words;
+    std::vector<uint64_t> m_bits[2];
+};
+
+/// Pivot markers by pivot label, each kept on the rank the caller assigns to the label.
+template <typename VertexId>
+class PivotRegistry {
+public:
+    explicit PivotRegistry(ygm::comm& world) : m_world(world) {
+        s_registry = this;
+    }
+
+    /// Enter (label, marker) on rank owner; it is there after the next barrier.
+    void add(int owner, VertexId label, VertexId marker) {
+        if (owner == m_world.rank()) {
+            m_markers.emplace(label, marker);
+        } else {
+            m_world.async(owner, [](VertexId label, VertexId marker) { s_registry->m_markers.emplace(label, marker); }, label, marker);
+            count_message(label, marker);
+        }
+    }
+
+    /**
+     * @brief Collectively look up this rank's labels, owner(label) naming the rank each was entered on.
+     *
+     * Every distinct label is asked for once. Returns the markers found.
+     */
+    template <typename Owner>
+    std::unordered_map<VertexId, VertexId> resolve(std::vector<VertexId> labels, Owner owner) {
+        std::unordered_map<VertexId, VertexId> found;
+        m_found = &found;
+        timed_barrier(m_world);
+
+        std::sort(labels.begin(), labels.end());
+        labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+        for (VertexId label : labels) {
+            m_world.async(owner(label), [](VertexId label, int asker) {
+                auto it = s_registry->m_markers.find(label);
+                if (it != s_registry->m_markers.end()) {
+                    s_registry->m_world.async(asker, [](VertexId label, VertexId marker) {
+                        s_registry->m_found->emplace(label, marker);
+                    }, label, it->second);
+                    count_message(label, it->second);
+                }
+            }, label, m_world.rank());
+            count_message(label, m_world.rank());
+        }
+        timed_barrier(m_world);
+
+        m_found = nullptr;
+        return found;
+    }
+
+private:
+    static inline PivotRegistry* s_registry = nullptr;
+
+    ygm::comm& m_world;
+    std::unordered_map<VertexId, VertexId> m_markers;
+    std::unordered_map<VertexId, VertexId>* m_found = nullptr;
+};
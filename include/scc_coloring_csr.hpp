@@ -0,0 +1,155 @@
+#pragma once
+
+#include <ygm/comm.hpp>
+
+#include "csr_graph.hpp"
+#include "local_first.hpp"
+#include "parallel_sweep.hpp"
+#include "pod_channel.hpp"
+
+// Coloring engine phases over a CsrGraph. Same algorithm and state as
+// scc_coloring_regular.hpp.
+
+inline void color_forward (ygm::comm &world, CsrGraph& graph, const ActiveList* active = nullptr) {
+    static CsrGraph* p_graph;
+    p_graph = &graph;
+
+    struct push_color;
+    static LocalFirstFrontier<CsrGraph, push_color, uint32_t>* p_push;
+
+    struct push_color {
+        static void seed(uint32_t lidx) {
+            if (p_graph->wcc_pivot[lidx] == uint32_t(-1)) {
+                p_graph->wcc_pivot[lidx] = p_graph->global_id(lidx);
+            }
+        }
+
+        void operator()(uint32_t lidx, uint32_t color) {
+            if (!p_graph->active[lidx]) {
+                return;
+            }
+
+            seed(lidx);
+            if (color <= p_graph->wcc_pivot[lidx]) {
+                return;
+            }
+
+            p_graph->wcc_pivot[lidx] = color;
+            p_graph->for_each_out(lidx, [color](uint32_t nbr) { p_push->visit(nbr, color); });
+            p_push->drain();
+        }
+    };
+
+    LocalFirstFrontier<CsrGraph, push_color, uint32_t> push(graph);
+    p_push = &push;
+
+    auto must_push = [&graph](uint32_t l) {
+        push_color::seed(l);
+
+        // a larger predecessor reaches everything this vertex does
+        uint32_t vtx = graph.global_id(l);
+        bool dominated = false;
+        graph.for_each_in(l, [&](uint32_t actr) { dominated = dominated || actr > vtx; });
+        return !dominated;
+    };
+
+    for (uint32_t l : select_active(graph, active, must_push)) {
+        uint32_t vtx = graph.global_id(l);
+        graph.for_each_out(l, [&](uint32_t desc) { push.visit(desc, vtx); });
+        push.drain();
+    }
+
+    timed_barrier(world);
+}
+
+inline void color_backward (ygm::comm &world, CsrGraph& graph, const ActiveList* active = nullptr) {
+    static CsrGraph* p_graph;
+    p_graph = &graph;
+
+    struct claim_scc;
+    static LocalFirstFrontier<CsrGraph, claim_scc, uint32_t>* p_claim;
+
+    struct claim_scc {
+        void operator()(uint32_t lidx, uint32_t color) {
+            if (!p_graph->active[lidx] || p_graph->mark_pred[lidx] || p_graph->wcc_pivot[lidx] != color) {
+                return;
+            }
+
+            p_graph->mark_pred[lidx] = true;
+            p_graph->mark_desc[lidx] = true;
+            p_graph->comp_id[lidx] = color;
+            p_graph->for_each_in(lidx, [color](uint32_t actr) { p_claim->visit(actr, color); });
+            p_claim->drain();
+        }
+    };
+
+    LocalFirstFrontier<CsrGraph, claim_scc, uint32_t> claim(graph);
+    p_claim = &claim;
+
+    auto is_root = [&graph](uint32_t l) { return graph.wcc_pivot[l] == graph.global_id(l); };
+    for (uint32_t l : select_active(graph, active, is_root)) {
+        uint32_t vtx = graph.global_id(l);
+
+        graph.mark_pred[l] = true;
+        graph.mark_desc[l] = true;
+        graph.comp_id[l] = vtx;
+        graph.for_each_in(l, [&](uint32_t actr) { claim.visit(actr, vtx); });
+        claim.drain();
+    }
+
+    timed_barrier(world);
+}
+
+inline void shear_colors (ygm::comm &world, CsrGraph& graph, TrimWorklist* work = nullptr, const ActiveList* active = nullptr,
+                          bool detect = false) {
+    struct remove_out;
+    static CsrGraph* p_graph;
+    static TrimWorklist* p_work;
+    static PodChannel<remove_out, uint32_t, uint32_t>* p_remove_out;
+    p_graph = &graph;
+    p_work = work;
+
+    struct remove_out {
+        void operator()(uint32_t lidx, uint32_t edge) {
+            p_graph->erase_out(lidx, edge);
+            if (p_work) {
+                p_work->add(lidx);
+            }
+        }
+    };
+
+    struct check_and_remove_in {
+        void operator()(uint32_t lidx, uint32_t sender, uint32_t s_color, bool s_scc) {
+            if (p_graph->wcc_pivot[lidx] != s_color || p_graph->mark_pred[lidx] != s_scc) {
+                p_graph->erase_in(lidx, sender);
+                if (p_work) {
+                    p_work->add(lidx);
+                }
+                p_remove_out->send(p_graph->owner(sender), p_graph->local_index(sender), p_graph->global_id(lidx));
+                count_message(lidx, sender);
+            }
+        }
+    };
+
+    PodChannel<remove_out, uint32_t, uint32_t> remove_outs(world);
+    PodChannel<check_and_remove_in, uint32_t, uint32_t, uint32_t, bool> checks(world);
+    p_remove_out = &remove_outs;
+
+    using edge = std::pair<uint32_t, uint32_t>;
+    for_all_active_buffered<edge>(graph, active, [&graph, detect](uint32_t l, std::vector<edge>& outbox) {
+        graph.for_each_out(l, [&](uint32_t nbr) { outbox.emplace_back(l, nbr); });
+
+        // pipelined mode, as in shear_edges
+        if (detect && graph.mark_pred[l] && graph.mark_desc[l]) {
+            graph.active[l] = false;
+        }
+    }, [&graph, &checks](const edge& e) {
+        uint32_t vtx = graph.global_id(e.first);
+        uint32_t color = graph.wcc_pivot[e.first];
+        bool scc = graph.mark_pred[e.first];
+        checks.send(graph.owner(e.second), graph.local_index(e.second), vtx, color, scc);
+        count_message(e.second, vtx, color, scc);
+    });
+
+    timed_barrier(world);
+}
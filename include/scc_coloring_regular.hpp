@@ -0,0 +1,176 @@
+#pragma once
+
+#include <ygm/comm.hpp>
+#include <ygm/container/map.hpp>
+
+#include "graph_util.hpp"
+#include "local_first.hpp"
+#include "pod_channel.hpp"
+
+// Multistep coloring SCC engine over the vertex map. One round is
+//   color_forward:  every active vertex takes the largest id that reaches it
+//   color_backward: each vertex whose color is its own id (a root) searches
+//                   backward inside its color; what it reaches is its SCC
+//   shear_colors:   drop edges between different colors and between an SCC
+//                   and the rest of its color, which no SCC can span
+// followed by the shared prep_unterminated, which finalizes the marked SCCs.
+// The color lives in wcc_pivot; the SCC mark and root reuse
+// mark_pred/mark_desc and comp_id, so no extra vertex state is needed.
+
+template <typename VertexId, typename Info>
+inline void color_forward (ygm::comm &world, ygm::container::map<VertexId, Info>& vertex_map, const BasicActiveList<VertexId>* active = nullptr) {
+    using map_type = ygm::container::map<VertexId, Info>;
+
+    struct push_color;
+    static LocalFirstFrontier<map_type, push_color, VertexId>* p_push;
+
+    struct push_color {
+        // a vertex starts with its own id as color when first looked at, so seeding needs no barrier
+        static void seed(VertexId vtx, Info& info) {
+            if (info.wcc_pivot == VertexId(-1)) {
+                info.wcc_pivot = vtx;
+            }
+        }
+
+        void operator()(const VertexId& vtx, Info& info, VertexId color) {
+            if (!info.active) {
+                return;
+            }
+
+            seed(vtx, info);
+            if (color <= info.wcc_pivot) {
+                return;
+            }
+
+            info.wcc_pivot = color;
+            for (auto desc : info.out) {
+                p_push->visit(desc, color);
+            }
+            p_push->drain();
+        }
+    };
+
+    LocalFirstFrontier<map_type, push_color, VertexId> push(vertex_map);
+    p_push = &push;
+
+    for_all_active(vertex_map, active, [](VertexId vtx, Info& info) {
+        push_color::seed(vtx, info);
+
+        // a larger predecessor reaches everything this vertex does
+        for (auto actr : info.in) {
+            if (actr > vtx) {
+                return;
+            }
+        }
+
+        for (auto desc : info.out) {
+            p_push->visit(desc, info.wcc_pivot);
+        }
+        p_push->drain();
+    });
+
+    timed_barrier(world);
+}
+
+template <typename VertexId, typename Info>
+inline void color_backward (ygm::comm &world, ygm::container::map<VertexId, Info>& vertex_map, const BasicActiveList<VertexId>* active = nullptr) {
+    using map_type = ygm::container::map<VertexId, Info>;
+
+    struct claim_scc;
+    static LocalFirstFrontier<map_type, claim_scc, VertexId>* p_claim;
+
+    struct claim_scc {
+        void operator()(const VertexId& vtx, Info& info, VertexId color) {
+            if (!info.active || info.mark_pred || info.wcc_pivot != color) {
+                return;
+            }
+
+            info.mark_pred = true;
+            info.mark_desc = true;
+            info.comp_id = color;
+            for (auto actr : info.in) {
+                p_claim->visit(actr, color);
+            }
+            p_claim->drain();
+        }
+    };
+
+    LocalFirstFrontier<map_type, claim_scc, VertexId> claim(vertex_map);
+    p_claim = &claim;
+
+    for_all_active(vertex_map, active, [](VertexId vtx, Info& info) {
+        if (info.wcc_pivot != vtx) {
+            return;
+        }
+
+        info.mark_pred = true;
+        info.mark_desc = true;
+        info.comp_id = vtx;
+        for (auto actr : info.in) {
+            p_claim->visit(actr, vtx);
+        }
+        p_claim->drain();
+    });
+
+    timed_barrier(world);
+}
+
+template <typename VertexId, typename Info>
+inline void shear_colors (ygm::comm &world, ygm::container::map<VertexId, Info>& vertex_map, BasicTrimWorklist<VertexId>* work = nullptr,
+                          const BasicActiveList<VertexId>* active = nullptr, bool detect = false) {
+
+    struct remove_out;
+    struct check_and_remove_in;
+    static ygm::container::map<VertexId, Info>* p_vertex_map;
+    static BasicTrimWorklist<VertexId>* p_work;
+    static PodChannel<remove_out, VertexId, VertexId>* p_remove;
+    static PodChannel<check_and_remove_in, VertexId, VertexId, VertexId, bool>* p_check;
+    p_vertex_map = &vertex_map;
+    p_work = work;
+
+    struct remove_out {
+        void operator()(VertexId vtx, VertexId edge) const {
+            p_vertex_map->local_visit(vtx, [](const VertexId& vtx, Info& info, VertexId edge) {
+                info.out.erase(edge);
+                if (p_work) {
+                    p_work->add(vtx);
+                }
+            }, edge);
+        }
+    };
+
+    struct check_and_remove_in {
+        void operator()(VertexId vtx, VertexId sender, VertexId s_color, bool s_scc) const {
+            p_vertex_map->local_visit(vtx, [](const VertexId& vtx, Info& info, VertexId sender, VertexId s_color, bool s_scc) {
+                if (info.wcc_pivot != s_color || info.mark_pred != s_scc) {
+                    info.in.erase(sender);
+                    if (p_work) {
+                        p_work->add(vtx);
+                    }
+                    p_remove->send(p_vertex_map->partitioner.owner(sender), sender, vtx);
+                    count_message(sender, vtx);
+                }
+            }, sender, s_color, s_scc);
+        }
+    };
+
+    PodChannel<remove_out, VertexId, VertexId> remove(world);
+    PodChannel<check_and_remove_in, VertexId, VertexId, VertexId, bool> check(world);
+    p_remove = &remove;
+    p_check = &check;
+
+    for_all_active(vertex_map, active, [detect](const VertexId& vtx, Info& info){
+        for (auto nbr : info.out) {
+            p_check->send(p_vertex_map->partitioner.owner(nbr), nbr, vtx, info.wcc_pivot, info.mark_pred);
+            count_message(nbr, vtx, info.wcc_pivot, info.mark_pred);
+        }
+
+        // pipelined mode, as in shear_edges
+        if (detect && info.mark_pred && info.mark_desc) {
+            info.active = false;
+            release_adjacency(info);
+        }
+    });
+
+    timed_barrier(world);
+}
@@ -0,0 +1,1005 @@
+#pragma once
+
+#include <ygm/comm.hpp>
+#include <ygm/detail/collective.hpp>
+
+#include "csr_graph.hpp"
+#include "local_first.hpp"
+#include "parallel_sweep.hpp"
+#include "pivot_priority.hpp"
+#include "pod_channel.hpp"
+#include "push_pull.hpp"
+
+// DCSC phases over a CsrGraph. Same algorithm and signatures as
+// scc_dcsc_regular.hpp; local sweeps are linear scans over the state
+// arrays, split over the OpenMP threads (see parallel_sweep.hpp), and
+// messages carry the target's local index. With mirror_hubs() the edges of
+// high-degree vertices are walked rank by rank instead (see HubMirrors).
+
+/// Run Handler()(slot, args...) on every rank for the hub in slot: in place here, as a message everywhere else.
+template <typename Handler, typename... Args>
+inline void hub_fan_out (CsrGraph& graph, uint32_t slot, const Args&... args) {
+    ygm::comm& world = graph.comm();
+    for (int rank = 0; rank < world.size(); ++rank) {
+        if (rank != world.rank()) {
+            world.async(rank, Handler(), slot, args...);
+            count_message(slot, args...);
+        }
+    }
+    Handler()(slot, args...);
+}
+
+/// Clear the per-iteration marks of a vertex that stays unterminated.
+inline void reset_iteration_state (CsrGraph& graph, uint32_t l) {
+    graph.mark_pred[l] = false;
+    graph.mark_desc[l] = false;
+    graph.comp_id[l] = -1;
+    graph.is_pivot[l] = false;
+    graph.wcc_pivot[l] = -1;
+}
+
+inline size_t prep_unterminated (ygm::comm &world, CsrGraph& graph, ActiveList* active = nullptr) {
+    size_t num_unterminated = 0;
+
+    timed_barrier(world);
+
+    std::vector<uint32_t> still_active = select_active(graph, active, [&graph](uint32_t l) {
+        // comp_id already holds the marker of the pivot, as in the vertex-map overload
+        if (graph.mark_pred[l] && graph.mark_desc[l]) {
+            graph.active[l] = false;
+            return false;
+        }
+
+        reset_iteration_state(graph, l);
+        return true;
+    }, &num_unterminated);
+
+    if (active) {
+        active->vertices.swap(still_active);
+        active->all = false;
+    }
+
+    num_unterminated = ygm::sum(num_unterminated, world);
+
+    timed_barrier(world);
+
+    return num_unterminated;
+}
+
+/// Pipelined-mode end of iteration; see the vertex-map overload.
+inline size_t reset_unterminated (ygm::comm &world, CsrGraph& graph, ActiveList* active = nullptr) {
+    std::vector<uint32_t> still_active = select_active(graph, active, [&graph](uint32_t l) {
+        reset_iteration_state(graph, l);
+        return true;
+    });
+
+    size_t num_unterminated = ygm::sum(still_active.size(), world);
+
+    if (active) {
+        active->vertices.swap(still_active);
+        active->all = false;
+    }
+
+    return num_unterminated;
+}
+
+inline void shear_edges (ygm::comm &world, CsrGraph& graph, TrimWorklist* work = nullptr, const ActiveList* active = nullptr,
+                         bool detect = false) {
+    struct remove_out;
+    struct remove_in;
+    struct check_and_remove_in;
+    static CsrGraph* p_graph;
+    static TrimWorklist* p_work;
+    static PodChannel<remove_out, uint32_t, uint32_t>* p_remove_out;
+    p_graph = &graph;
+    p_work = work;
+
+    struct remove_out {
+        void operator()(uint32_t lidx, uint32_t edge) {
+            p_graph->erase_out(lidx, edge);
+            if (p_work) {
+                p_work->add(lidx);
+            }
+        }
+    };
+
+    struct remove_in {
+        void operator()(uint32_t lidx, uint32_t edge) {
+            p_graph->erase_in(lidx, edge);
+            if (p_work) {
+                p_work->add(lidx);
+            }
+        }
+    };
+
+    struct mirror_marks {
+        void operator()(uint32_t slot, bool active, bool pred, bool desc) {
+            p_graph->hubs.active[slot] = active;
+            p_graph->hubs.mark_pred[slot] = pred;
+            p_graph->hubs.mark_desc[slot] = desc;
+        }
+    };
+
+    struct check_and_remove_in {
+        void operator()(uint32_t lidx, uint32_t sender, bool s_pred, bool s_desc) {
+            if (p_graph->mark_pred[lidx] != s_pred || p_graph->mark_desc[lidx] != s_desc) {
+                p_graph->erase_in(lidx, sender);
+                if (p_work) {
+                    p_work->add(lidx);
+                }
+                p_remove_out->send(p_graph->owner(sender), p_graph->local_index(sender), p_graph->global_id(lidx));
+                count_message(lidx, sender);
+            }
+        }
+    };
+
+    PodChannel<remove_out, uint32_t, uint32_t> remove_outs(world);
+    PodChannel<remove_in, uint32_t, uint32_t> remove_ins(world);
+    PodChannel<check_and_remove_in, uint32_t, uint32_t, bool, bool> checks(world);
+    p_remove_out = &remove_outs;
+
+    // hubs: the owners publish the marks, then each edge is checked where its other endpoint lives
+    HubMirrors& hubs = graph.hubs;
+    if (!hubs.empty()) {
+        for (uint32_t slot = 0; slot < hubs.size(); ++slot) {
+            uint32_t hub = hubs.hub(slot);
+            if (graph.owner(hub) == world.rank()) {
+                uint32_t l = graph.local_index(hub);
+                hub_fan_out<mirror_marks>(graph, slot, bool(graph.active[l]), bool(graph.mark_pred[l]),
+                                          bool(graph.mark_desc[l]));
+            }
+        }
+        timed_barrier(world);
+    }
+
+    // the threads collect (lidx, neighbor) pairs; the marks they are sent with do not change during the sweep
+    using edge = std::pair<uint32_t, uint32_t>;
+    for_all_active_buffered<edge>(graph, active, [&graph, &hubs, detect](uint32_t l, std::vector<edge>& outbox) {
+        // the out-edges of a hub are checked by the ranks of their targets below
+        if (hubs.slot(graph.global_id(l)) == HubMirrors::kNoHub) {
+            graph.for_each_out(l, [&](uint32_t nbr) { outbox.emplace_back(l, nbr); });
+        }
+
+        // pipelined mode: retire a marked SCC now, keeping its marks for the checks still to come
+        if (detect && graph.mark_pred[l] && graph.mark_desc[l]) {
+            graph.active[l] = false;
+        }
+    }, [&graph, &hubs, work, &remove_ins, &checks](const edge& e) {
+        uint32_t vtx = graph.global_id(e.first);
+        bool pred = graph.mark_pred[e.first];
+        bool desc = graph.mark_desc[e.first];
+
+        uint32_t slot = hubs.slot(e.second);
+        if (slot != HubMirrors::kNoHub) {
+            // against the mirrored marks only an edge that has to go costs a message
+            if (hubs.mark_pred[slot] != pred || hubs.mark_desc[slot] != desc) {
+                graph.erase_out(e.first, e.second);
+                if (work) {
+                    work->add(e.first);
+                }
+                remove_ins.send(graph.owner(e.second), graph.local_index(e.second), vtx);
+                count_message(e.second, vtx);
+            }
+            return;
+        }
+
+        checks.send(graph.owner(e.second), graph.local_index(e.second), vtx, pred, desc);
+        count_message(e.second, vtx, pred, desc);
+    });
+
+    // the edges out of hubs that were active when the marks were published
+    for (uint32_t slot = 0; slot < hubs.size(); ++slot) {
+        if (!hubs.active[slot]) {
+            continue;
+        }
+
+        uint32_t hub = hubs.hub(slot);
+        hubs.for_each_out_of(graph, slot, [&](uint32_t l) {
+            if (graph.mark_pred[l] != hubs.mark_pred[slot] || graph.mark_desc[l] != hubs.mark_desc[slot]) {
+                graph.erase_in(l, hub);
+                if (work) {
+                    work->add(l);
+                }
+                remove_outs.send(graph.owner(hub), graph.local_index(hub), graph.global_id(l));
+                count_message(hub, graph.global_id(l));
+            }
+        });
+    }
+
+    timed_barrier(world);
+}
+
+
+inline void prop_pivots (ygm::comm &world, CsrGraph& graph, const ActiveList* active = nullptr) {
+    static CsrGraph* p_graph;
+    p_graph = &graph;
+
+    struct comp_pivot_fwd;
+    struct comp_pivot_bwd;
+    static LocalFirstFrontier<CsrGraph, comp_pivot_fwd, uint32_t, uint32_t>* p_fwd;
+    static LocalFirstFrontier<CsrGraph, comp_pivot_bwd, uint32_t, uint32_t>* p_bwd;
+
+    // a hub's turn on one rank: visit the local ends of its out- (fwd) or in-edges (bwd)
+    struct hub_fwd {
+        void operator()(uint32_t slot, uint32_t pivot, uint32_t marker) {
+            p_graph->hubs.for_each_out_of(*p_graph, slot, [&](uint32_t l) {
+                p_fwd->visit(p_graph->global_id(l), pivot, marker);
+            });
+            p_fwd->drain();
+        }
+    };
+
+    struct hub_bwd {
+        void operator()(uint32_t slot, uint32_t pivot, uint32_t marker) {
+            p_graph->hubs.for_each_into(*p_graph, slot, [&](uint32_t l) {
+                p_bwd->visit(p_graph->global_id(l), pivot, marker);
+            });
+            p_bwd->drain();
+        }
+    };
+
+    // A pivot value belongs to one pivot vertex, so it also fixes the marker and a hub needs it only once.
+    struct comp_pivot_fwd {
+        static void visit(uint32_t vtx, uint32_t pivot, uint32_t marker) {
+            uint32_t slot = p_graph->hubs.slot(vtx);
+            if (slot != HubMirrors::kNoHub) {
+                if (p_graph->hubs.sent_fwd[slot] == pivot) {
+                    return;
+                }
+                p_graph->hubs.sent_fwd[slot] = pivot;
+            }
+            p_fwd->visit(vtx, pivot, marker);
+        }
+
+        static void spread(uint32_t lidx, uint32_t pivot, uint32_t marker) {
+            uint32_t slot = p_graph->hubs.slot(p_graph->global_id(lidx));
+            if (slot != HubMirrors::kNoHub) {
+                hub_fan_out<hub_fwd>(*p_graph, slot, pivot, marker);
+            } else {
+                p_graph->for_each_out(lidx, [&](uint32_t nbr) { visit(nbr, pivot, marker); });
+            }
+            p_fwd->drain();
+        }
+
+        void operator()(uint32_t lidx, uint32_t pivot, uint32_t marker) {
+            if (!p_graph->active[lidx] || p_graph->mark_desc[lidx]) {
+                return;
+            }
+
+            if (pivot == p_graph->wcc_pivot[lidx]) {
+                p_graph->mark_desc[lidx] = true;
+                p_graph->comp_id[lidx] = marker;
+
+                spread(lidx, pivot, marker);
+            }
+        }
+    };
+
+    struct comp_pivot_bwd {
+        static void visit(uint32_t vtx, uint32_t pivot, uint32_t marker) {
+            uint32_t slot = p_graph->hubs.slot(vtx);
+            if (slot != HubMirrors::kNoHub) {
+                if (p_graph->hubs.sent_bwd[slot] == pivot) {
+                    return;
+                }
+                p_graph->hubs.sent_bwd[slot] = pivot;
+            }
+            p_bwd->visit(vtx, pivot, marker);
+        }
+
+        static void spread(uint32_t lidx, uint32_t pivot, uint32_t marker) {
+            uint32_t slot = p_graph->hubs.slot(p_graph->global_id(lidx));
+            if (slot != HubMirrors::kNoHub) {
+                hub_fan_out<hub_bwd>(*p_graph, slot, pivot, marker);
+            } else {
+                p_graph->for_each_in(lidx, [&](uint32_t nbr) { visit(nbr, pivot, marker); });
+            }
+            p_bwd->drain();
+        }
+
+        void operator()(uint32_t lidx, uint32_t pivot, uint32_t marker) {
+            if (!p_graph->active[lidx] || p_graph->mark_pred[lidx]) {
+                return;
+            }
+
+            if (pivot == p_graph->wcc_pivot[lidx]) {
+                p_graph->mark_pred[lidx] = true;
+                p_graph->comp_id[lidx] = marker;
+
+                spread(lidx, pivot, marker);
+            }
+        }
+    };
+
+    LocalFirstFrontier<CsrGraph, comp_pivot_fwd, uint32_t, uint32_t> fwd(graph);
+    LocalFirstFrontier<CsrGraph, comp_pivot_bwd, uint32_t, uint32_t> bwd(graph);
+    p_fwd = &fwd;
+    p_bwd = &bwd;
+
+    std::fill(graph.hubs.sent_fwd.begin(), graph.hubs.sent_fwd.end(), uint32_t(-1));
+    std::fill(graph.hubs.sent_bwd.begin(), graph.hubs.sent_bwd.end(), uint32_t(-1));
+
+    auto is_pivot = [&graph](uint32_t l) { return graph.is_pivot[l]; };
+    for (uint32_t l : select_active(graph, active, is_pivot)) {
+        uint32_t vtx = graph.global_id(l);
+        uint32_t pivot = graph.wcc_pivot[l];
+
+        graph.mark_desc[l] = true;
+        graph.mark_pred[l] = true;
+        graph.comp_id[l] = vtx;
+
+        comp_pivot_bwd::spread(l, pivot, vtx);
+        comp_pivot_fwd::spread(l, pivot, vtx);
+    }
+
+    timed_barrier(world);
+}
+
+
+/// prop_pivots_push_pull over a CsrGraph; see the vertex-map overload. Hubs push through their mirrors, and the pull sweeps run on the threads.
+inline void prop_pivots_push_pull (ygm::comm &world, CsrGraph& graph, uint32_t min, uint32_t max, const ActiveList* active = nullptr) {
+    static CsrGraph* p_graph;
+    static ReachDirection<uint32_t>* p_dirs;
+    ReachDirection<uint32_t> dirs[2];   // frontiers of local indices
+    p_graph = &graph;
+    p_dirs = dirs;
+
+    struct reach_fwd {
+        void operator()(uint32_t lidx, uint32_t pivot, uint32_t marker) {
+            if (!p_graph->active[lidx] || p_graph->mark_desc[lidx] || pivot != p_graph->wcc_pivot[lidx]) {
+                return;
+            }
+            p_graph->mark_desc[lidx] = true;
+            if (marker != uint32_t(-1)) {
+                p_graph->comp_id[lidx] = marker;
+            }
+            p_dirs[0].marked(lidx, p_graph->out_degree(lidx), p_graph->in_degree(lidx));
+        }
+    };
+
+    struct reach_bwd {
+        void operator()(uint32_t lidx, uint32_t pivot, uint32_t marker) {
+            if (!p_graph->active[lidx] || p_graph->mark_pred[lidx] || pivot != p_graph->wcc_pivot[lidx]) {
+                return;
+            }
+            p_graph->mark_pred[lidx] = true;
+            if (marker != uint32_t(-1)) {
+                p_graph->comp_id[lidx] = marker;
+            }
+            p_dirs[1].marked(lidx, p_graph->in_degree(lidx), p_graph->out_degree(lidx));
+        }
+    };
+
+    static LocalFirstFrontier<CsrGraph, reach_fwd, uint32_t, uint32_t>* p_fwd;
+    static LocalFirstFrontier<CsrGraph, reach_bwd, uint32_t, uint32_t>* p_bwd;
+    LocalFirstFrontier<CsrGraph, reach_fwd, uint32_t, uint32_t> fwd(graph);
+    LocalFirstFrontier<CsrGraph, reach_bwd, uint32_t, uint32_t> bwd(graph);
+    p_fwd = &fwd;
+    p_bwd = &bwd;
+
+    struct hub_fwd {
+        void operator()(uint32_t slot, uint32_t pivot, uint32_t marker) {
+            p_graph->hubs.for_each_out_of(*p_graph, slot, [&](uint32_t l) { p_fwd->visit(p_graph->global_id(l), pivot, marker); });
+            p_fwd->drain();
+        }
+    };
+
+    struct hub_bwd {
+        void operator()(uint32_t slot, uint32_t pivot, uint32_t marker) {
+            p_graph->hubs.for_each_into(*p_graph, slot, [&](uint32_t l) { p_bwd->visit(p_graph->global_id(l), pivot, marker); });
+            p_bwd->drain();
+        }
+    };
+
+    std::vector<std::pair<uint32_t, uint32_t>> pivots;
+    uint64_t num_active = 0;
+    for (uint32_t l : select_active(graph, active, [](uint32_t l) { return true; })) {
+        ++num_active;
+        dirs[0].unmarked_edges += graph.in_degree(l);
+        dirs[1].unmarked_edges += graph.out_degree(l);
+
+        if (graph.is_pivot[l]) {
+            graph.mark_desc[l] = true;
+            graph.mark_pred[l] = true;
+            graph.comp_id[l] = graph.global_id(l);
+            dirs[0].marked(l, graph.out_degree(l), graph.in_degree(l));
+            dirs[1].marked(l, graph.in_degree(l), graph.out_degree(l));
+            pivots.emplace_back(graph.wcc_pivot[l], graph.global_id(l));
+        }
+    }
+    num_active = ygm::sum(num_active, world);
+
+    ReachBitmaps<uint32_t> bitmaps(min, max);
+    PivotRegistry<uint32_t> registry(world);
+    bool pulled = false;
+
+    while (next_reach_round(world, dirs, num_active, bitmaps.words())) {
+        if (dirs[0].pull || dirs[1].pull) {
+            if (!pulled) {
+                for (const auto& [label, marker] : pivots) {
+                    registry.add(graph.owner(label), label, marker);
+                }
+                pulled = true;
+            }
+
+            bitmaps.reset(dirs);
+            for (uint32_t l = 0; l < graph.num_local(); ++l) {
+                if (graph.active[l] && dirs[0].pull && graph.mark_desc[l]) {
+                    bitmaps.set(0, graph.global_id(l));
+                }
+                if (graph.active[l] && dirs[1].pull && graph.mark_pred[l]) {
+                    bitmaps.set(1, graph.global_id(l));
+                }
+            }
+            bitmaps.reduce(world);
+
+            // as in the vertex-map overload, each sweep only reads the marks of the previous round
+            auto test_fwd = [&bitmaps](uint32_t actr) { return bitmaps.test(0, actr); };
+            auto test_bwd = [&bitmaps](uint32_t desc) { return bitmaps.test(1, desc); };
+            if (dirs[0].pull) {
+                auto pull = [&](uint32_t l) {
+                    if (graph.mark_desc[l] || !graph.any_in(l, test_fwd)) {
+                        return false;
+                    }
+                    graph.mark_desc[l] = true;
+                    return true;
+                };
+                for (uint32_t l : select_active(graph, active, pull)) {
+                    dirs[0].marked(l, graph.out_degree(l), graph.in_degree(l));
+                }
+            }
+            if (dirs[1].pull) {
+                auto pull = [&](uint32_t l) {
+                    if (graph.mark_pred[l] || !graph.any_out(l, test_bwd)) {
+                        return false;
+                    }
+                    graph.mark_pred[l] = true;
+                    return true;
+                };
+                for (uint32_t l : select_active(graph, active, pull)) {
+                    dirs[1].marked(l, graph.in_degree(l), graph.out_degree(l));
+                }
+            }
+        }
+
+        if (!dirs[0].pull) {
+            for (uint32_t l : dirs[0].frontier) {
+                uint32_t pivot = graph.wcc_pivot[l];
+                uint32_t marker = graph.comp_id[l];
+                uint32_t slot = graph.hubs.slot(graph.global_id(l));
+                if (slot != HubMirrors::kNoHub) {
+                    hub_fan_out<hub_fwd>(graph, slot, pivot, marker);
+                } else {
+                    graph.for_each_out(l, [&](uint32_t desc) { fwd.visit(desc, pivot, marker); });
+                }
+            }
+            fwd.drain();
+        }
+        if (!dirs[1].pull) {
+            for (uint32_t l : dirs[1].frontier) {
+                uint32_t pivot = graph.wcc_pivot[l];
+                uint32_t marker = graph.comp_id[l];
+                uint32_t slot = graph.hubs.slot(graph.global_id(l));
+                if (slot != HubMirrors::kNoHub) {
+                    hub_fan_out<hub_bwd>(graph, slot, pivot, marker);
+                } else {
+                    graph.for_each_in(l, [&](uint32_t actr) { bwd.visit(actr, pivot, marker); });
+                }
+            }
+            bwd.drain();
+        }
+        timed_barrier(world);
+    }
+
+    if (!pulled) {
+        return;
+    }
+
+    // markers for the SCC members that pulled both marks from remote neighbors
+    auto unlabeled = [&graph](uint32_t l) { return graph.mark_desc[l] && graph.mark_pred[l] && graph.comp_id[l] == uint32_t(-1); };
+    std::vector<uint32_t> members = select_active(graph, active, unlabeled);
+    std::vector<uint32_t> labels;
+    for (uint32_t l : members) {
+        labels.push_back(graph.wcc_pivot[l]);
+    }
+    auto markers = registry.resolve(std::move(labels), [&graph](uint32_t label) { return graph.owner(label); });
+    for (uint32_t l : members) {
+        graph.comp_id[l] = markers.at(graph.wcc_pivot[l]);
+    }
+
+    timed_barrier(world);
+}
+
+
+inline void init_wcc_pivots (ygm::comm &world, CsrGraph& graph, size_t iter, uint32_t min, uint32_t max,
+                             const ActiveList* active = nullptr, PivotPolicy policy = PivotPolicy::random) {
+    static CsrGraph* p_graph;
+    p_graph = &graph;
+
+    // Need a random seed value to choose who gets to be the pivot
+    uint64_t seed = 0x9E3779B97F4A7C15ULL + iter;  // 64-bit golden ratio
+    PivotPriority priority(min, max, seed, policy);
+    static PivotPriority* p_priority;
+    p_priority = &priority;
+
+
+    // settle on smallest pivot
+    struct share_pivot;
+    static MinCombiningFrontier<CsrGraph, share_pivot>* p_share;
+
+    // a hub's turn on one rank; visits into a hub need no help, the frontier sends each rank's smallest label once
+    struct hub_share {
+        void operator()(uint32_t slot, uint32_t pivot) {
+            auto send = [pivot](uint32_t l) { p_share->visit(p_graph->global_id(l), pivot); };
+            p_graph->hubs.for_each_out_of(*p_graph, slot, send);
+            p_graph->hubs.for_each_into(*p_graph, slot, send);
+            p_share->drain();
+        }
+    };
+
+    struct share_pivot {
+        // seeded on first touch, as in the vertex-map overload
+        static void seed(uint32_t lidx) {
+            if (p_graph->wcc_pivot[lidx] == uint32_t(-1)) {
+                p_graph->wcc_pivot[lidx] = (*p_priority)(p_graph->global_id(lidx), p_graph->in_degree(lidx), p_graph->out_degree(lidx));
+                p_graph->is_pivot[lidx] = true;
+            }
+        }
+
+        // Offer pivot to every neighbor of lidx, through the ranks' mirrors if it is a hub.
+        static void spread(uint32_t lidx, uint32_t pivot) {
+            uint32_t slot = p_graph->hubs.slot(p_graph->global_id(lidx));
+            if (slot != HubMirrors::kNoHub) {
+                hub_fan_out<hub_share>(*p_graph, slot, pivot);
+            } else {
+                auto send = [pivot](uint32_t nbr) { p_share->visit(nbr, pivot); };
+                p_graph->for_each_out(lidx, send);
+                p_graph->for_each_in(lidx, send);
+            }
+            p_share->drain();
+        }
+
+        void operator()(uint32_t lidx, uint32_t pivot) {
+            if (!p_graph->active[lidx]) {
+                return;
+            }
+
+            seed(lidx);
+            if (pivot < p_graph->wcc_pivot[lidx]) {
+                p_graph->wcc_pivot[lidx] = pivot;
+                p_graph->is_pivot[lidx] = false;
+                spread(lidx, pivot);
+            }
+        }
+    };
+
+    MinCombiningFrontier<CsrGraph, share_pivot> share(graph);
+    p_share = &share;
+
+    // combine the sweep's remote labels into at most one per target
+    share.hold();
+
+    // seeding and the preemption test run on the threads; only the vertices that still have to send come back
+    auto must_send = [&graph, &priority](uint32_t l) {
+        share_pivot::seed(l);
+        if (!priority.uses_ids_only()) {
+            return true;
+        }
+
+        // preempt unnecessary communication: permute the live neighbors in one batch
+        static thread_local std::vector<uint32_t> nbrs;
+        nbrs.clear();
+        auto gather = [](uint32_t nbr) { nbrs.push_back(nbr); };
+        graph.for_each_out(l, gather);
+        graph.for_each_in(l, gather);
+        return !priority.permuter().any_below(nbrs.data(), nbrs.size(), graph.wcc_pivot[l]);
+    };
+
+    for (uint32_t l : select_active(graph, active, must_send)) {
+        share_pivot::spread(l, graph.wcc_pivot[l]);
+    }
+    share.release();
+
+    timed_barrier(world);
+}
+
+
+/// init_wcc_pivots and prop_pivots in one quiescence (pipelined mode); see the vertex-map overload.
+inline void mark_wcc_pivots (ygm::comm &world, CsrGraph& graph, size_t iter, uint32_t min, uint32_t max,
+                             const ActiveList* active = nullptr, PivotPolicy policy = PivotPolicy::random) {
+    static CsrGraph* p_graph;
+    p_graph = &graph;
+
+    uint64_t seed = 0x9E3779B97F4A7C15ULL + iter;  // same priorities as init_wcc_pivots
+    PivotPriority priority(min, max, seed, policy);
+    static PivotPriority* p_priority;
+    p_priority = &priority;
+
+    struct share_pivot;
+    struct comp_pivot_fwd;
+    struct comp_pivot_bwd;
+    static MinCombiningFrontier<CsrGraph, share_pivot>* p_share;
+    static LocalFirstFrontier<CsrGraph, comp_pivot_fwd, uint32_t, uint32_t>* p_fwd;
+    static LocalFirstFrontier<CsrGraph, comp_pivot_bwd, uint32_t, uint32_t>* p_bwd;
+
+    // a hub's turn on one rank, for a shared label and for either wave
+    struct hub_share {
+        void operator()(uint32_t slot, uint32_t pivot) {
+            auto send = [pivot](uint32_t l) { p_share->visit(p_graph->global_id(l), pivot); };
+            p_graph->hubs.for_each_out_of(*p_graph, slot, send);
+            p_graph->hubs.for_each_into(*p_graph, slot, send);
+            p_share->drain();
+        }
+    };
+
+    struct hub_fwd {
+        void operator()(uint32_t slot, uint32_t pivot, uint32_t marker) {
+            p_graph->hubs.for_each_out_of(*p_graph, slot, [&](uint32_t l) {
+                p_fwd->visit(p_graph->global_id(l), pivot, marker);
+            });
+            p_fwd->drain();
+        }
+    };
+
+    struct hub_bwd {
+        void operator()(uint32_t slot, uint32_t pivot, uint32_t marker) {
+            p_graph->hubs.for_each_into(*p_graph, slot, [&](uint32_t l) {
+                p_bwd->visit(p_graph->global_id(l), pivot, marker);
+            });
+            p_bwd->drain();
+        }
+    };
+
+    struct share_pivot {
+        static void seed(uint32_t lidx) {
+            if (p_graph->wcc_pivot[lidx] == uint32_t(-1)) {
+                p_graph->wcc_pivot[lidx] = (*p_priority)(p_graph->global_id(lidx), p_graph->in_degree(lidx), p_graph->out_degree(lidx));
+                p_graph->is_pivot[lidx] = true;
+            }
+        }
+
+        static void spread(uint32_t lidx, uint32_t pivot) {
+            uint32_t slot = p_graph->hubs.slot(p_graph->global_id(lidx));
+            if (slot != HubMirrors::kNoHub) {
+                hub_fan_out<hub_share>(*p_graph, slot, pivot);
+            } else {
+                auto send = [pivot](uint32_t nbr) { p_share->visit(nbr, pivot); };
+                p_graph->for_each_out(lidx, send);
+                p_graph->for_each_in(lidx, send);
+            }
+            p_share->drain();
+        }
+
+        // the smaller label replaces the old one and its marks
+        static bool settle(uint32_t lidx, uint32_t pivot) {
+            seed(lidx);
+            if (pivot < p_graph->wcc_pivot[lidx]) {
+                p_graph->wcc_pivot[lidx] = pivot;
+                p_graph->is_pivot[lidx] = false;
+                p_graph->mark_pred[lidx] = false;
+                p_graph->mark_desc[lidx] = false;
+                p_graph->comp_id[lidx] = -1;
+                spread(lidx, pivot);
+            }
+            return pivot == p_graph->wcc_pivot[lidx];
+        }
+
+        void operator()(uint32_t lidx, uint32_t pivot) {
+            if (p_graph->active[lidx]) {
+                settle(lidx, pivot);
+            }
+        }
+    };
+
+    // as in prop_pivots, a hub needs a given wave from each rank only once
+    struct comp_pivot_fwd {
+        static void visit(uint32_t vtx, uint32_t pivot, uint32_t marker) {
+            uint32_t slot = p_graph->hubs.slot(vtx);
+            if (slot != HubMirrors::kNoHub) {
+                if (p_graph->hubs.sent_fwd[slot] == pivot) {
+                    return;
+                }
+                p_graph->hubs.sent_fwd[slot] = pivot;
+            }
+            p_fwd->visit(vtx, pivot, marker);
+        }
+
+        static void spread(uint32_t lidx, uint32_t pivot, uint32_t marker) {
+            uint32_t slot = p_graph->hubs.slot(p_graph->global_id(lidx));
+            if (slot != HubMirrors::kNoHub) {
+                hub_fan_out<hub_fwd>(*p_graph, slot, pivot, marker);
+            } else {
+                p_graph->for_each_out(lidx, [&](uint32_t nbr) { visit(nbr, pivot, marker); });
+            }
+            p_fwd->drain();
+        }
+
+        void operator()(uint32_t lidx, uint32_t pivot, uint32_t marker) {
+            if (!p_graph->active[lidx] || !share_pivot::settle(lidx, pivot) || p_graph->mark_desc[lidx]) {
+                return;
+            }
+
+            p_graph->mark_desc[lidx] = true;
+            p_graph->comp_id[lidx] = marker;
+            spread(lidx, pivot, marker);
+        }
+    };
+
+    struct comp_pivot_bwd {
+        static void visit(uint32_t vtx, uint32_t pivot, uint32_t marker) {
+            uint32_t slot = p_graph->hubs.slot(vtx);
+            if (slot != HubMirrors::kNoHub) {
+                if (p_graph->hubs.sent_bwd[slot] == pivot) {
+                    return;
+                }
+                p_graph->hubs.sent_bwd[slot] = pivot;
+            }
+            p_bwd->visit(vtx, pivot, marker);
+        }
+
+        static void spread(uint32_t lidx, uint32_t pivot, uint32_t marker) {
+            uint32_t slot = p_graph->hubs.slot(p_graph->global_id(lidx));
+            if (slot != HubMirrors::kNoHub) {
+                hub_fan_out<hub_bwd>(*p_graph, slot, pivot, marker);
+            } else {
+                p_graph->for_each_in(lidx, [&](uint32_t nbr) { visit(nbr, pivot, marker); });
+            }
+            p_bwd->drain();
+        }
+
+        void operator()(uint32_t lidx, uint32_t pivot, uint32_t marker) {
+            if (!p_graph->active[lidx] || !share_pivot::settle(lidx, pivot) || p_graph->mark_pred[lidx]) {
+                return;
+            }
+
+            p_graph->mark_pred[lidx] = true;
+            p_graph->comp_id[lidx] = marker;
+            spread(lidx, pivot, marker);
+        }
+    };
+
+    MinCombiningFrontier<CsrGraph, share_pivot> share(graph);
+    LocalFirstFrontier<CsrGraph, comp_pivot_fwd, uint32_t, uint32_t> fwd(graph);
+    LocalFirstFrontier<CsrGraph, comp_pivot_bwd, uint32_t, uint32_t> bwd(graph);
+    p_share = &share;
+    p_fwd = &fwd;
+    p_bwd = &bwd;
+
+    std::fill(graph.hubs.sent_fwd.begin(), graph.hubs.sent_fwd.end(), uint32_t(-1));
+    std::fill(graph.hubs.sent_bwd.begin(), graph.hubs.sent_bwd.end(), uint32_t(-1));
+
+    share.hold();
+
+    // seeding and the preemption test on the threads, as in init_wcc_pivots
+    auto must_send = [&graph, &priority](uint32_t l) {
+        share_pivot::seed(l);
+        if (!priority.uses_ids_only()) {
+            return true;
+        }
+
+        static thread_local std::vector<uint32_t> nbrs;
+        nbrs.clear();
+        auto gather = [](uint32_t nbr) { nbrs.push_back(nbr); };
+        graph.for_each_out(l, gather);
+        graph.for_each_in(l, gather);
+        return !priority.permuter().any_below(nbrs.data(), nbrs.size(), graph.wcc_pivot[l]);
+    };
+
+    for (uint32_t l : select_active(graph, active, must_send)) {
+        share_pivot::spread(l, graph.wcc_pivot[l]);
+
+        // messages that arrived since the threads seeded it may have taken its label away
+        if (graph.is_pivot[l]) {
+            // the backward wave may deliver a smaller label here; the forward one still carries this pivot's
+            uint32_t vtx = graph.global_id(l);
+            uint32_t pivot = graph.wcc_pivot[l];
+            graph.mark_desc[l] = true;
+            graph.mark_pred[l] = true;
+            graph.comp_id[l] = vtx;
+
+            comp_pivot_bwd::spread(l, pivot, vtx);
+            comp_pivot_fwd::spread(l, pivot, vtx);
+        }
+    }
+    share.release();
+
+    timed_barrier(world);
+}
+
+
+/// Forward-backward opening phase; see the vertex-map overload.
+inline uint32_t init_fwbw_pivot (ygm::comm &world, CsrGraph& graph) {
+    uint64_t best_score = 0;
+    uint32_t best_vtx = -1;
+
+    for (uint32_t l = 0; l < graph.num_local(); ++l) {
+        if (!graph.active[l]) {
+            continue;
+        }
+
+        uint64_t score = uint64_t(graph.in_degree(l)) * graph.out_degree(l);
+        if (best_vtx == uint32_t(-1) || score > best_score) {
+            best_score = score;
+            best_vtx = graph.global_id(l);
+        }
+    }
+
+    // highest score wins, ties go to the smallest id
+    uint64_t top_score = ygm::max(best_score, world);
+    uint32_t pivot = ygm::min(best_score == top_score ? best_vtx : uint32_t(-1), world);
+
+    for (uint32_t l = 0; l < graph.num_local(); ++l) {
+        if (graph.active[l]) {
+            graph.wcc_pivot[l] = kFwbwPivot;
+            graph.is_pivot[l] = graph.global_id(l) == pivot;
+        }
+    }
+
+    timed_barrier(world);
+
+    return pivot;
+}
+
+
+/// Singleton and (with pairs) Trim-2 trimming; see the vertex-map overload.
+inline void trim_trivial (ygm::comm &world, CsrGraph& graph, TrimWorklist* work = nullptr, bool pairs = false) {
+    static CsrGraph* p_graph;
+    p_graph = &graph;
+
+    struct trim_vtx;
+    struct trim_pair;
+    static LocalFirstFrontier<CsrGraph, trim_vtx, uint32_t, bool>* p_trim;
+    static LocalFirstFrontier<CsrGraph, trim_pair, uint32_t, bool>* p_pair;
+    static std::vector<uint32_t>* p_touched;
+
+    struct trim_vtx {
+        // Retire lidx if it has lost all of its in- or out-edges and tell the other side.
+        static void retire_if_trivial(uint32_t lidx) {
+            uint32_t vtx = p_graph->global_id(lidx);
+
+            if (p_graph->in_degree(lidx) == 0) {
+                p_graph->comp_id[lidx] = vtx;
+                p_graph->active[lidx] = false;
+
+                p_graph->for_each_out(lidx, [&](uint32_t desc) { p_trim->visit(desc, vtx, true); });
+                p_graph->clear_out(lidx);
+            } else if (p_graph->out_degree(lidx) == 0) {
+                p_graph->comp_id[lidx] = vtx;
+                p_graph->active[lidx] = false;
+
+                p_graph->for_each_in(lidx, [&](uint32_t actr) { p_trim->visit(actr, vtx, false); });
+                p_graph->clear_in(lidx);
+            }
+            p_trim->drain();
+        }
+
+        void operator()(uint32_t lidx, uint32_t sender, bool direction) {
+            if (!p_graph->active[lidx]) {
+                return;
+            }
+
+            // for direction, true = sender had no ancestors, false = no descendants
+            if (direction) {
+                p_graph->erase_in(lidx, sender);
+            } else {
+                p_graph->erase_out(lidx, sender);
+            }
+
+            p_touched->push_back(lidx);
+            retire_if_trivial(lidx);
+        }
+    };
+
+    struct trim_pair {
+        // The single in- (in_side) or out-neighbor of lidx, if it has exactly one and an edge back to it.
+        static uint32_t only_partner(uint32_t lidx, bool in_side) {
+            uint32_t partner = -1;
+            if (in_side && p_graph->in_degree(lidx) == 1) {
+                p_graph->for_each_in(lidx, [&](uint32_t actr) { partner = actr; });
+                return p_graph->has_out(lidx, partner) ? partner : uint32_t(-1);
+            }
+            if (!in_side && p_graph->out_degree(lidx) == 1) {
+                p_graph->for_each_out(lidx, [&](uint32_t desc) { partner = desc; });
+                return p_graph->has_in(lidx, partner) ? partner : uint32_t(-1);
+            }
+            return partner;
+        }
+
+        void operator()(uint32_t lidx, uint32_t partner, bool in_side) {
+            if (!p_graph->active[lidx] || only_partner(lidx, in_side) != partner) {
+                return;
+            }
+
+            uint32_t vtx = p_graph->global_id(lidx);
+            p_graph->comp_id[lidx] = std::min(vtx, partner);
+            p_graph->active[lidx] = false;
+
+            p_graph->for_each_out(lidx, [&](uint32_t desc) {
+                if (desc != partner) {
+                    p_trim->visit(desc, vtx, true);
+                }
+            });
+            p_graph->for_each_in(lidx, [&](uint32_t actr) {
+                if (actr != partner) {
+                    p_trim->visit(actr, vtx, false);
+                }
+            });
+            p_graph->clear_out(lidx);
+            p_graph->clear_in(lidx);
+
+            // the partner already qualified when it asked, so echoing retires it too
+            p_pair->visit(partner, vtx, in_side);
+            p_trim->drain();
+            p_pair->drain();
+        }
+    };
+
+    std::vector<uint32_t> touched;
+    LocalFirstFrontier<CsrGraph, trim_vtx, uint32_t, bool> trim(graph);
+    LocalFirstFrontier<CsrGraph, trim_pair, uint32_t, bool> pair(graph);
+    p_trim = &trim;
+    p_pair = &pair;
+    p_touched = &touched;
+
+    const bool sweep = work == nullptr || work->all;
+    std::vector<uint32_t> candidates;
+    if (!sweep) {
+        candidates = work->take();
+    }
+    const std::vector<uint32_t>* first_list = sweep ? nullptr : &candidates;
+
+    // the degree tests run on the threads; a vertex can have been retired by an earlier cascade when its turn comes
+    auto trivial = [&graph](uint32_t l) { return graph.in_degree(l) == 0 || graph.out_degree(l) == 0; };
+    for (uint32_t l : select_active(graph, first_list, trivial)) {
+        if (graph.active[l]) {
+            trim_vtx::retire_if_trivial(l);
+        }
+    }
+
+    timed_barrier(world);
+
+    if (pairs) {
+        auto check_pair = [&graph, &pair](uint32_t l) {
+            if (!graph.active[l]) {
+                return;
+            }
+
+            uint32_t vtx = graph.global_id(l);
+            for (bool in_side : {true, false}) {
+                uint32_t partner = trim_pair::only_partner(l, in_side);
+                if (partner != uint32_t(-1)) {
+                    pair.visit(partner, vtx, in_side);
+                }
+            }
+            pair.drain();
+        };
+
+        bool first_round = true;
+        do {
+            if (first_round && sweep) {
+                touched.clear();
+                auto one_sided = [&graph](uint32_t l) { return graph.in_degree(l) == 1 || graph.out_degree(l) == 1; };
+                for (uint32_t l : select_active(graph, first_list, one_sided)) {
+                    check_pair(l);
+                }
+            } else {
+                TrimWorklist round;
+                round.all = false;
+                round.vertices.swap(touched);
+                if (first_round) {
+                    round.vertices.insert(round.vertices.end(), candidates.begin(), candidates.end());
+                }
+                for (uint32_t l : round.take()) {
+                    check_pair(l);
+                }
+            }
+            first_round = false;
+
+            timed_barrier(world);
+        } while (ygm::sum(touched.size(), world) > 0);
+    }
+
+    if (work) {
+        work->all = false;
+    }
+}
@@ -5,232 +5,705 @@
 #include <ygm/detail/collective.hpp>
 
 #include "graph_util.hpp"
-#include "fpp_vertex_permuter.hpp"
+#include "local_first.hpp"
+#include "pivot_priority.hpp"
+#include "pod_channel.hpp"
+#include "push_pull.hpp"
+
+/// Clear the per-iteration marks of a vertex that stays unterminated.
+template <typename Info>
+inline void reset_iteration_state (Info& info) {
+    info.mark_pred = false;
+    info.mark_desc = false;
+    info.comp_id = -1;
+    info.is_pivot = false;
+    info.wcc_pivot = -1;
+
+    // reclaim the slots that shear/trim tombstoned this iteration
+    info.out.compact();
+    info.in.compact();
+}
 
-inline size_t prep_unterminated (ygm::comm &world, ygm::container::map<uint32_t, VtxInfo>& vertex_map) {
+template <typename VertexId, typename Info>
+inline size_t prep_unterminated (ygm::comm &world, ygm::container::map<VertexId, Info>& vertex_map, BasicActiveList<VertexId>* active = nullptr) {
     size_t num_unterminated = 0;
+    std::vector<VertexId> still_active;
 
-    vertex_map.for_all([&num_unterminated](const uint32_t& vtx, VtxInfo& info){
-        if (!info.active) {
-            return;
-        }
+    timed_barrier(world);
 
+    for_all_active(vertex_map, active, [&num_unterminated, &still_active](const VertexId& vtx, Info& info){
         num_unterminated++;
 
+        // a vertex marked both ways already carries its pivot's marker as comp_id
         if(info.mark_pred && info.mark_desc) 
         {
             info.active = false;
-            info.comp_id = info.my_marker;
+            release_adjacency(info);
         } else {
-            info.mark_pred = false;
-            info.mark_desc = false;
-            info.my_marker = -1; 
-            info.my_pivot = -1;
-            info.wcc_pivot = -1;
+            reset_iteration_state(info);
+            still_active.push_back(vtx);
         }
     });
 
+    if (active) {
+        active->vertices.swap(still_active);
+        active->all = false;
+    }
+
     num_unterminated = ygm::sum(num_unterminated, world);
 
-    world.barrier();
+    timed_barrier(world);
 
     return num_unterminated;
 }
 
-inline void shear_edges (ygm::comm &world, ygm::container::map<uint32_t, VtxInfo>& vertex_map) {
-
-    static auto p_vertex_map = &vertex_map;
-    size_t num_unterminated = 0; 
+/**
+ * @brief Finish an iteration whose shear pass already retired the marked SCCs (pipelined mode).
+ *
+ * Resets the vertices still active like prep_unterminated does and rebuilds
+ * the active list. Nothing is sent, so the count of those vertices, which
+ * is returned, is the only collective.
+ */
+template <typename VertexId, typename Info>
+inline size_t reset_unterminated (ygm::comm &world, ygm::container::map<VertexId, Info>& vertex_map, BasicActiveList<VertexId>* active = nullptr) {
+    std::vector<VertexId> still_active;
+
+    for_all_active(vertex_map, active, [&still_active](const VertexId& vtx, Info& info){
+        reset_iteration_state(info);
+        still_active.push_back(vtx);
+    });
 
-    vertex_map.local_for_all([&vertex_map, &num_unterminated](const uint32_t& vtx, VtxInfo& info){
+    size_t num_unterminated = ygm::sum(still_active.size(), world);
 
-        if (!info.active) {
-            return;
-        }
+    if (active) {
+        active->vertices.swap(still_active);
+        active->all = false;
+    }
 
-        auto check_and_remove_in = [] (const uint32_t& vtx, VtxInfo& info, uint32_t sender, bool s_pred, bool s_desc) {
+    return num_unterminated;
+}
 
-            auto remove_out = [] (uint32_t, VtxInfo& info, uint64_t edge) {
+template <typename VertexId, typename Info>
+inline void shear_edges (ygm::comm &world, ygm::container::map<VertexId, Info>& vertex_map, BasicTrimWorklist<VertexId>* work = nullptr,
+                         const BasicActiveList<VertexId>* active = nullptr, bool detect = false) {
+
+    struct remove_out;
+    struct check_and_remove_in;
+    static ygm::container::map<VertexId, Info>* p_vertex_map;
+    static BasicTrimWorklist<VertexId>* p_work;
+    static PodChannel<remove_out, VertexId, VertexId>* p_remove;
+    static PodChannel<check_and_remove_in, VertexId, VertexId, bool, bool>* p_check;
+    p_vertex_map = &vertex_map;
+    p_work = work;
+
+    struct remove_out {
+        void operator()(VertexId vtx, VertexId edge) const {
+            p_vertex_map->local_visit(vtx, [](const VertexId& vtx, Info& info, VertexId edge) {
                 info.out.erase(edge);
-            };
+                if (p_work) {
+                    p_work->add(vtx);
+                }
+            }, edge);
+        }
+    };
 
-            if (info.mark_pred != s_pred || info.mark_desc != s_desc) {
-                info.in.erase(sender);
-                p_vertex_map->async_visit(sender, remove_out, vtx);
-            }
-        };
+    struct check_and_remove_in {
+        void operator()(VertexId vtx, VertexId sender, bool s_pred, bool s_desc) const {
+            p_vertex_map->local_visit(vtx, [](const VertexId& vtx, Info& info, VertexId sender, bool s_pred, bool s_desc) {
+                if (info.mark_pred != s_pred || info.mark_desc != s_desc) {
+                    info.in.erase(sender);
+                    if (p_work) {
+                        p_work->add(vtx);
+                    }
+                    p_remove->send(p_vertex_map->partitioner.owner(sender), sender, vtx);
+                    count_message(sender, vtx);
+                }
+            }, sender, s_pred, s_desc);
+        }
+    };
+
+    PodChannel<remove_out, VertexId, VertexId> remove(world);
+    PodChannel<check_and_remove_in, VertexId, VertexId, bool, bool> check(world);
+    p_remove = &remove;
+    p_check = &check;
 
+    for_all_active(vertex_map, active, [detect](const VertexId& vtx, Info& info){
         for (auto nbr : info.out) {
-            p_vertex_map->async_visit(nbr, check_and_remove_in, vtx, info.mark_pred, info.mark_desc);
+            p_check->send(p_vertex_map->partitioner.owner(nbr), nbr, vtx, info.mark_pred, info.mark_desc);
+            count_message(nbr, vtx, info.mark_pred, info.mark_desc);
+        }
+
+        // the marks are final, so a marked SCC can retire now; it keeps its marks for the shear checks still to come
+        if (detect && info.mark_pred && info.mark_desc) {
+            info.active = false;
+            release_adjacency(info);
         }
     });
-    
-    world.barrier();
+
+    timed_barrier(world);
 }
 
 
-inline void prop_pivots (ygm::comm &world, ygm::container::map<uint32_t, VtxInfo>& vertex_map) {
-    static auto p_vertex_map = &vertex_map;
+template <typename VertexId, typename Info>
+inline void prop_pivots (ygm::comm &world, ygm::container::map<VertexId, Info>& vertex_map, const BasicActiveList<VertexId>* active = nullptr) {
+    using map_type = ygm::container::map<VertexId, Info>;
+
+    struct comp_pivot_fwd;
+    struct comp_pivot_bwd;
+    static LocalFirstFrontier<map_type, comp_pivot_fwd, VertexId, VertexId>* p_fwd;
+    static LocalFirstFrontier<map_type, comp_pivot_bwd, VertexId, VertexId>* p_bwd;
 
     struct comp_pivot_fwd {
-        void operator()(const uint32_t& vtx, VtxInfo& info, uint32_t pivot, uint32_t marker){
+        void operator()(const VertexId& vtx, Info& info, VertexId pivot, VertexId marker){
             if (!info.active || info.mark_desc) {
                 return;
             }
 
             if (pivot == info.wcc_pivot) {
                 info.mark_desc = true;
-                info.my_marker = marker;
+                info.comp_id = marker;
 
                 for (auto nbr : info.out) {
-                    p_vertex_map->async_visit(nbr, comp_pivot_fwd(), pivot, marker);
+                    p_fwd->visit(nbr, pivot, marker);
                 }
+                p_fwd->drain();
             }
         }
     };
 
     struct comp_pivot_bwd {
-        void operator()(const uint32_t& vtx, VtxInfo& info, uint32_t pivot, uint32_t marker){
+        void operator()(const VertexId& vtx, Info& info, VertexId pivot, VertexId marker){
             if (!info.active || info.mark_pred) {
                 return;
             }
 
             if (pivot == info.wcc_pivot) {
                 info.mark_pred = true;
-                info.my_marker = marker;
+                info.comp_id = marker;
 
                 for (auto nbr : info.in) {
-                    p_vertex_map->async_visit(nbr, comp_pivot_bwd(), pivot, marker);
+                    p_bwd->visit(nbr, pivot, marker);
                 }
+                p_bwd->drain();
             }
         }
     };
 
-    vertex_map.local_for_all([&vertex_map](const uint32_t& vtx, VtxInfo& info){
+    LocalFirstFrontier<map_type, comp_pivot_fwd, VertexId, VertexId> fwd(vertex_map);
+    LocalFirstFrontier<map_type, comp_pivot_bwd, VertexId, VertexId> bwd(vertex_map);
+    p_fwd = &fwd;
+    p_bwd = &bwd;
 
-        if (!info.active) {
-            return;
-        }
+    for_all_active(vertex_map, active, [](const VertexId& vtx, Info& info){
 
-        if (info.wcc_pivot == info.my_pivot) {
+        if (info.is_pivot) {
             info.mark_desc = true;
             info.mark_pred = true;
-            info.my_marker = vtx;
+            info.comp_id = vtx;
 
 
             for (auto nbr : info.in) {
-                p_vertex_map->async_visit(nbr, comp_pivot_bwd(), info.wcc_pivot, vtx);
+                p_bwd->visit(nbr, info.wcc_pivot, vtx);
             }
 
             for (auto nbr : info.out) {
-                p_vertex_map->async_visit(nbr, comp_pivot_fwd(), info.wcc_pivot, vtx);
+                p_fwd->visit(nbr, info.wcc_pivot, vtx);
             }
 
+            p_bwd->drain();
+            p_fwd->drain();
         }
     });
 
-    world.barrier();
+    timed_barrier(world);
 }
 
 
-inline void init_wcc_pivots (ygm::comm &world, ygm::container::map<uint32_t, VtxInfo> &vertex_map, size_t iter, uint32_t min, uint32_t max) {
-    static auto p_vertex_map = &vertex_map;
+/**
+ * @brief prop_pivots in direction-optimizing rounds; same marks and markers, see push_pull.hpp.
+ *
+ * Direction 0 is the forward reach (mark_desc, along out-edges), 1 the
+ * backward one (mark_pred, along in-edges). min and max bound the active
+ * vertex ids.
+ */
+template <typename VertexId, typename Info>
+inline void prop_pivots_push_pull (ygm::comm &world, ygm::container::map<VertexId, Info>& vertex_map, VertexId min, VertexId max,
+                                   const BasicActiveList<VertexId>* active = nullptr) {
+    using map_type = ygm::container::map<VertexId, Info>;
+
+    static ReachDirection<VertexId>* p_dirs;
+    ReachDirection<VertexId> dirs[2];
+    p_dirs = dirs;
+
+    // a push marks without spreading; the marked vertex walks its edges next round
+    struct reach_fwd {
+        void operator()(const VertexId& vtx, Info& info, VertexId pivot, VertexId marker) {
+            if (!info.active || info.mark_desc || pivot != info.wcc_pivot) {
+                return;
+            }
+            info.mark_desc = true;
+            if (marker != VertexId(-1)) {
+                info.comp_id = marker;
+            }
+            p_dirs[0].marked(vtx, info.out.size(), info.in.size());
+        }
+    };
 
-    // Need a random seed value to choose who gets to be the pivot
-    uint64_t seed = 0x9E3779B97F4A7C15ULL + iter;  // 64-bit golden ratio
-    FppPermuter perm(min, max, seed);
+    struct reach_bwd {
+        void operator()(const VertexId& vtx, Info& info, VertexId pivot, VertexId marker) {
+            if (!info.active || info.mark_pred || pivot != info.wcc_pivot) {
+                return;
+            }
+            info.mark_pred = true;
+            if (marker != VertexId(-1)) {
+                info.comp_id = marker;
+            }
+            p_dirs[1].marked(vtx, info.in.size(), info.out.size());
+        }
+    };
+
+    static LocalFirstFrontier<map_type, reach_fwd, VertexId, VertexId>* p_fwd;
+    static LocalFirstFrontier<map_type, reach_bwd, VertexId, VertexId>* p_bwd;
+    LocalFirstFrontier<map_type, reach_fwd, VertexId, VertexId> fwd(vertex_map);
+    LocalFirstFrontier<map_type, reach_bwd, VertexId, VertexId> bwd(vertex_map);
+    p_fwd = &fwd;
+    p_bwd = &bwd;
+
+    std::vector<std::pair<VertexId, VertexId>> pivots;
+    uint64_t num_active = 0;
+    for_all_active(vertex_map, active, [&](const VertexId& vtx, Info& info) {
+        ++num_active;
+        dirs[0].unmarked_edges += info.in.size();
+        dirs[1].unmarked_edges += info.out.size();
+
+        if (info.is_pivot) {
+            info.mark_desc = true;
+            info.mark_pred = true;
+            info.comp_id = vtx;
+            dirs[0].marked(vtx, info.out.size(), info.in.size());
+            dirs[1].marked(vtx, info.in.size(), info.out.size());
+            pivots.emplace_back(info.wcc_pivot, vtx);
+        }
+    });
+    num_active = ygm::sum(num_active, world);
 
+    ReachBitmaps<VertexId> bitmaps(min, max);
+    PivotRegistry<VertexId> registry(world);
+    bool pulled = false;
 
-    vertex_map.local_for_all([&vertex_map, &perm] (uint32_t vtx, VtxInfo& info) {
-        if (info.active) {
-            info.my_pivot = perm(vtx);
-            info.wcc_pivot = info.my_pivot;
-            info.my_marker = vtx;
+    while (next_reach_round(world, dirs, num_active, bitmaps.words())) {
+        if (dirs[0].pull || dirs[1].pull) {
+            if (!pulled) {
+                for (const auto& [label, marker] : pivots) {
+                    registry.add(vertex_map.partitioner.owner(label), label, marker);
+                }
+                pulled = true;
+            }
+
+            bitmaps.reset(dirs);
+            for_all_active(vertex_map, active, [&](const VertexId& vtx, Info& info) {
+                if (dirs[0].pull && info.mark_desc) {
+                    bitmaps.set(0, vtx);
+                }
+                if (dirs[1].pull && info.mark_pred) {
+                    bitmaps.set(1, vtx);
+                }
+            });
+            bitmaps.reduce(world);
+
+            // the marks set here only show in the next round's bitmaps, so each round is one level
+            for_all_active(vertex_map, active, [&](const VertexId& vtx, Info& info) {
+                if (dirs[0].pull && !info.mark_desc) {
+                    for (auto actr : info.in) {
+                        if (bitmaps.test(0, actr)) {
+                            info.mark_desc = true;
+                            dirs[0].marked(vtx, info.out.size(), info.in.size());
+                            break;
+                        }
+                    }
+                }
+                if (dirs[1].pull && !info.mark_pred) {
+                    for (auto desc : info.out) {
+                        if (bitmaps.test(1, desc)) {
+                            info.mark_pred = true;
+                            dirs[1].marked(vtx, info.in.size(), info.out.size());
+                            break;
+                        }
+                    }
+                }
+            });
+        }
+
+        if (!dirs[0].pull) {
+            for (VertexId vtx : dirs[0].frontier) {
+                vertex_map.local_visit(vtx, [](const VertexId& vtx, Info& info) {
+                    for (auto desc : info.out) {
+                        p_fwd->visit(desc, info.wcc_pivot, info.comp_id);
+                    }
+                });
+            }
+            fwd.drain();
+        }
+        if (!dirs[1].pull) {
+            for (VertexId vtx : dirs[1].frontier) {
+                vertex_map.local_visit(vtx, [](const VertexId& vtx, Info& info) {
+                    for (auto actr : info.in) {
+                        p_bwd->visit(actr, info.wcc_pivot, info.comp_id);
+                    }
+                });
+            }
+            bwd.drain();
+        }
+        timed_barrier(world);
+    }
+
+    if (!pulled) {
+        return;
+    }
+
+    // markers for the SCC members that pulled both marks from remote neighbors
+    std::vector<VertexId> unlabeled;
+    for_all_active(vertex_map, active, [&unlabeled](const VertexId& vtx, Info& info) {
+        if (info.mark_desc && info.mark_pred && info.comp_id == VertexId(-1)) {
+            unlabeled.push_back(info.wcc_pivot);
         }
     });
+    auto markers = registry.resolve(std::move(unlabeled), [&vertex_map](VertexId label) { return vertex_map.partitioner.owner(label); });
+    for_all_active(vertex_map, active, [&markers](const VertexId& vtx, Info& info) {
+        if (info.mark_desc && info.mark_pred && info.comp_id == VertexId(-1)) {
+            info.comp_id = markers.at(info.wcc_pivot);
+        }
+    });
+
+    timed_barrier(world);
+}
 
-    world.barrier();
+
+template <typename VertexId, typename Info>
+inline void init_wcc_pivots (ygm::comm &world, ygm::container::map<VertexId, Info> &vertex_map, size_t iter, VertexId min, VertexId max,
+                             const BasicActiveList<VertexId>* active = nullptr, PivotPolicy policy = PivotPolicy::random) {
+    using map_type = ygm::container::map<VertexId, Info>;
+
+    // Need a random seed value to choose who gets to be the pivot
+    uint64_t seed = 0x9E3779B97F4A7C15ULL + iter;  // 64-bit golden ratio
+    BasicPivotPriority<VertexId> priority(min, max, seed, policy);
+    static BasicPivotPriority<VertexId>* p_priority;
+    p_priority = &priority;
 
 
     // settle on smallest pivot
+    struct share_pivot;
+    static MinCombiningFrontier<map_type, share_pivot>* p_share;
+
     struct share_pivot {
-        void operator()(const uint32_t& vtx, VtxInfo& info, uint32_t pivot){
+        // A vertex takes its own pivot when it is first looked at, by the sweep below or by a
+        // neighbor's label that got here first, so seeding needs no barrier of its own.
+        static void seed(VertexId vtx, Info& info) {
+            if (info.wcc_pivot == VertexId(-1)) {
+                info.wcc_pivot = (*p_priority)(vtx, info.in.size(), info.out.size());
+                info.is_pivot = true;
+            }
+        }
+
+        void operator()(const VertexId& vtx, Info& info, VertexId pivot){
             if (!info.active) {
                 return;
             }
 
+            seed(vtx, info);
             if (pivot < info.wcc_pivot) {
                 info.wcc_pivot = pivot; 
+                info.is_pivot = false;
 
                 for (auto desc : info.out) {
-                    p_vertex_map->async_visit(desc, share_pivot(), pivot);
+                    p_share->visit(desc, pivot);
                 }
 
                 for (auto actr : info.in) {
-                    p_vertex_map->async_visit(actr, share_pivot(), pivot);
+                    p_share->visit(actr, pivot);
                 }
 
+                p_share->drain();
             }
         }
     };
 
-    vertex_map.local_for_all([&](uint32_t vtx, VtxInfo& info){
-        if (!info.active) {
-            return;
-        }
+    MinCombiningFrontier<map_type, share_pivot> share(vertex_map);
+    p_share = &share;
 
-        // preempt unnecessary communication
-        for (auto desc : info.out) {
-            if (perm(desc) < info.wcc_pivot) {
-                return;
-            }
-        }
+    // combine the sweep's remote labels into at most one per target
+    share.hold();
 
-        // preempt unnnecessary communication
-        for (auto actr : info.in) {
-            if (perm(actr) < info.wcc_pivot) {
+    std::vector<VertexId> nbrs;
+    for_all_active(vertex_map, active, [&](VertexId vtx, Info& info){
+        share_pivot::seed(vtx, info);
+
+        // preempt unnecessary communication: permute the whole neighborhood in one batch
+        if (priority.uses_ids_only()) {
+            nbrs.clear();
+            for (auto desc : info.out) {
+                nbrs.push_back(desc);
+            }
+            for (auto actr : info.in) {
+                nbrs.push_back(actr);
+            }
+            if (priority.permuter().any_below(nbrs.data(), nbrs.size(), info.wcc_pivot)) {
                 return;
             }
         }
 
         for (auto desc : info.out) {
-            p_vertex_map->async_visit(desc, share_pivot(), info.wcc_pivot);
+            p_share->visit(desc, info.wcc_pivot);
         }
 
         for (auto actr : info.in) {
-            p_vertex_map->async_visit(actr, share_pivot(), info.wcc_pivot);
+            p_share->visit(actr, info.wcc_pivot);
         }
+
+        p_share->drain();
     });
+    share.release();
 
-    world.barrier();
+    timed_barrier(world);
 }
 
 
-inline void trim_trivial (ygm::comm &world, ygm::container::map<uint32_t, VtxInfo>& vertex_map) {
-    static auto p_vertex_map = &vertex_map;
+/**
+ * @brief init_wcc_pivots and prop_pivots in one quiescence, ending in a single barrier (pipelined mode).
+ *
+ * Every vertex that is still its own pivot when the sweep reaches it starts
+ * its marking waves right away instead of waiting for the labels to settle.
+ * Marks and waves carry the pivot label they belong to. A vertex that sees a
+ * smaller label, by a shared label or by a wave reaching it, adopts it and
+ * drops the marks of its old one; a wave for a larger label than a vertex
+ * holds is stale and stops there. Labels only decrease, so once the
+ * component has settled on its smallest label, every mark left was set by
+ * the wave of that label's pivot, which reached the same vertices it would
+ * have in prop_pivots. The waves of the pivots that lose cost extra
+ * messages in exchange for the barrier.
+ */
+template <typename VertexId, typename Info>
+inline void mark_wcc_pivots (ygm::comm &world, ygm::container::map<VertexId, Info> &vertex_map, size_t iter, VertexId min, VertexId max,
+                             const BasicActiveList<VertexId>* active = nullptr, PivotPolicy policy = PivotPolicy::random) {
+    using map_type = ygm::container::map<VertexId, Info>;
+
+    uint64_t seed = 0x9E3779B97F4A7C15ULL + iter;  // same priorities as init_wcc_pivots
+    BasicPivotPriority<VertexId> priority(min, max, seed, policy);
+    static BasicPivotPriority<VertexId>* p_priority;
+    p_priority = &priority;
+
+    struct share_pivot;
+    struct comp_pivot_fwd;
+    struct comp_pivot_bwd;
+    static MinCombiningFrontier<map_type, share_pivot>* p_share;
+    static LocalFirstFrontier<map_type, comp_pivot_fwd, VertexId, VertexId>* p_fwd;
+    static LocalFirstFrontier<map_type, comp_pivot_bwd, VertexId, VertexId>* p_bwd;
 
-    struct trim_vtx {
-        void operator()(const uint32_t& vtx, VtxInfo& info, uint32_t sender, bool direction){
+    struct share_pivot {
+        static void seed(VertexId vtx, Info& info) {
+            if (info.wcc_pivot == VertexId(-1)) {
+                info.wcc_pivot = (*p_priority)(vtx, info.in.size(), info.out.size());
+                info.is_pivot = true;
+            }
+        }
 
-            if (!info.active) {
+        // Take the smaller label pivot: forget the marks of the old one and pass it on.
+        static void adopt(Info& info, VertexId pivot) {
+            info.wcc_pivot = pivot;
+            info.is_pivot = false;
+            info.mark_pred = false;
+            info.mark_desc = false;
+            info.comp_id = -1;
+
+            for (auto desc : info.out) {
+                p_share->visit(desc, pivot);
+            }
+            for (auto actr : info.in) {
+                p_share->visit(actr, pivot);
+            }
+            p_share->drain();
+        }
+
+        // Seed info and settle it against pivot; whether a wave of pivot applies to it.
+        static bool settle(VertexId vtx, Info& info, VertexId pivot) {
+            seed(vtx, info);
+            if (pivot < info.wcc_pivot) {
+                adopt(info, pivot);
+            }
+            return pivot == info.wcc_pivot;
+        }
+
+        void operator()(const VertexId& vtx, Info& info, VertexId pivot){
+            if (info.active) {
+                settle(vtx, info, pivot);
+            }
+        }
+    };
+
+    struct comp_pivot_fwd {
+        void operator()(const VertexId& vtx, Info& info, VertexId pivot, VertexId marker){
+            if (!info.active || !share_pivot::settle(vtx, info, pivot) || info.mark_desc) {
                 return;
             }
 
-            // for direction, true = sender had no ancestors, false = no descendants
-            if (direction == true) {
-                info.in.erase(sender);
+            info.mark_desc = true;
+            info.comp_id = marker;
+            for (auto nbr : info.out) {
+                p_fwd->visit(nbr, pivot, marker);
             }
+            p_fwd->drain();
+        }
+    };
 
-            if (direction == false) {
-                info.out.erase(sender);
+    struct comp_pivot_bwd {
+        void operator()(const VertexId& vtx, Info& info, VertexId pivot, VertexId marker){
+            if (!info.active || !share_pivot::settle(vtx, info, pivot) || info.mark_pred) {
+                return;
             }
 
+            info.mark_pred = true;
+            info.comp_id = marker;
+            for (auto nbr : info.in) {
+                p_bwd->visit(nbr, pivot, marker);
+            }
+            p_bwd->drain();
+        }
+    };
+
+    MinCombiningFrontier<map_type, share_pivot> share(vertex_map);
+    LocalFirstFrontier<map_type, comp_pivot_fwd, VertexId, VertexId> fwd(vertex_map);
+    LocalFirstFrontier<map_type, comp_pivot_bwd, VertexId, VertexId> bwd(vertex_map);
+    p_share = &share;
+    p_fwd = &fwd;
+    p_bwd = &bwd;
+
+    share.hold();
+
+    std::vector<VertexId> nbrs;
+    for_all_active(vertex_map, active, [&](VertexId vtx, Info& info){
+        share_pivot::seed(vtx, info);
+
+        // a vertex with a neighbor of smaller priority loses its label, so it neither shares it nor marks with it
+        if (priority.uses_ids_only()) {
+            nbrs.clear();
+            for (auto desc : info.out) {
+                nbrs.push_back(desc);
+            }
+            for (auto actr : info.in) {
+                nbrs.push_back(actr);
+            }
+            if (priority.permuter().any_below(nbrs.data(), nbrs.size(), info.wcc_pivot)) {
+                return;
+            }
+        }
+
+        for (auto desc : info.out) {
+            p_share->visit(desc, info.wcc_pivot);
+        }
+        for (auto actr : info.in) {
+            p_share->visit(actr, info.wcc_pivot);
+        }
+
+        // still holding its own label: its waves start now, and are dropped wherever a smaller label got first
+        if (info.is_pivot) {
+            VertexId pivot = info.wcc_pivot;
+            info.mark_desc = true;
+            info.mark_pred = true;
+            info.comp_id = vtx;
+
+            for (auto nbr : info.in) {
+                p_bwd->visit(nbr, pivot, vtx);
+            }
+            for (auto nbr : info.out) {
+                p_fwd->visit(nbr, pivot, vtx);
+            }
+        }
+
+        p_share->drain();
+        p_bwd->drain();
+        p_fwd->drain();
+    });
+    share.release();
+
+    timed_barrier(world);
+}
+
+
+/**
+ * @brief Seed a single forward-backward search from the active vertex with the largest in*out degree.
+ *
+ * Every active vertex joins one component labeled kFwbwPivot and only the
+ * chosen vertex is its pivot, so the following prop_pivots / shear_edges /
+ * prep_unterminated pass finalizes the pivot's whole SCC (the giant one on
+ * power-law graphs) and splits the rest into its FW-only, BW-only and
+ * unreached parts. Returns the pivot vertex, or -1 if nothing is active.
+ */
+template <typename VertexId, typename Info>
+inline VertexId init_fwbw_pivot (ygm::comm &world, ygm::container::map<VertexId, Info> &vertex_map) {
+    uint64_t best_score = 0;
+    VertexId best_vtx = -1;
+
+    vertex_map.local_for_all([&best_score, &best_vtx](VertexId vtx, Info& info) {
+        if (!info.active) {
+            return;
+        }
+
+        uint64_t score = uint64_t(info.in.size()) * info.out.size();
+        if (best_vtx == VertexId(-1) || score > best_score || (score == best_score && vtx < best_vtx)) {
+            best_score = score;
+            best_vtx = vtx;
+        }
+    });
+
+    // highest score wins, ties go to the smallest id
+    uint64_t top_score = ygm::max(best_score, world);
+    VertexId pivot = ygm::min(best_score == top_score ? best_vtx : VertexId(-1), world);
+
+    vertex_map.local_for_all([pivot](VertexId vtx, Info& info) {
+        if (info.active) {
+            info.wcc_pivot = kFwbwPivot;
+            info.is_pivot = vtx == pivot;
+        }
+    });
+
+    timed_barrier(world);
+
+    return pivot;
+}
+
+
+/**
+ * @brief Retire trivial SCCs.
+ *
+ * Vertices with no ancestors or no descendants left are singleton SCCs;
+ * retiring one updates its neighbors, which may cascade. With pairs set,
+ * Trim-2 then retires mutually connected pairs u <-> v where one of them
+ * has no other in-edges and the other none either (or the same for
+ * out-edges), iterated with the singleton cascade until nothing changes.
+ *
+ * With a worklist that no longer has `all` set, only the vertices recorded
+ * there (the ones shear_edges took edges from) are examined instead of
+ * sweeping the whole map.
+ */
+template <typename VertexId, typename Info>
+inline void trim_trivial (ygm::comm &world, ygm::container::map<VertexId, Info>& vertex_map,
+                          BasicTrimWorklist<VertexId>* work = nullptr, bool pairs = false) {
+    using map_type = ygm::container::map<VertexId, Info>;
+
+    struct trim_vtx;
+    struct trim_pair;
+    static LocalFirstFrontier<map_type, trim_vtx, VertexId, bool>* p_trim;
+    static LocalFirstFrontier<map_type, trim_pair, VertexId, bool>* p_pair;
+    static std::vector<VertexId>* p_touched;
+
+    struct trim_vtx {
+        static void retire_if_trivial(VertexId vtx, Info& info) {
             if (info.in.empty()) {
                 info.comp_id = vtx;
                 info.active = false;
 
                 for (auto desc : info.out) {
-                    p_vertex_map->async_visit(desc, trim_vtx(), vtx, true);
+                    p_trim->visit(desc, vtx, true);
                 }
 
                 info.out.clear();
@@ -242,40 +715,136 @@ inline void trim_trivial (ygm::comm &world, ygm::container::map<uint32_t, VtxInf
                 info.active = false;
 
                 for (auto actr : info.in) {
-                    p_vertex_map->async_visit(actr, trim_vtx(), vtx, false);
+                    p_trim->visit(actr, vtx, false);
                 }
 
                 info.in.clear();
+            }
+        }
+
+        void operator()(const VertexId& vtx, Info& info, VertexId sender, bool direction){
+
+            if (!info.active) {
                 return;
             }
+
+            // for direction, true = sender had no ancestors, false = no descendants
+            if (direction == true) {
+                info.in.erase(sender);
+            }
+
+            if (direction == false) {
+                info.out.erase(sender);
+            }
+
+            p_touched->push_back(vtx);
+            retire_if_trivial(vtx, info);
+            p_trim->drain();
         }
     };
 
-    vertex_map.local_for_all([&vertex_map] (uint32_t vtx, VtxInfo& info) {
+    struct trim_pair {
+        // in_side: partner is vtx's only ancestor, else its only descendant; either way the edge back must exist
+        static bool is_pair(const Info& info, VertexId partner, bool in_side) {
+            const auto& only = in_side ? info.in : info.out;
+            const auto& back = in_side ? info.out : info.in;
+            return only.size() == 1 && *only.begin() == partner && back.contains(partner);
+        }
 
-        if (info.active)
-        {
-            if(info.in.empty()) {
-                info.comp_id = vtx;
-                info.active = false;
+        void operator()(const VertexId& vtx, Info& info, VertexId partner, bool in_side){
+            if (!info.active || !is_pair(info, partner, in_side)) {
+                return;
+            }
 
-                for (auto desc : info.out) {
-                    p_vertex_map->async_visit(desc, trim_vtx(), vtx, true);
+            info.comp_id = std::min(vtx, partner);
+            info.active = false;
+
+            for (auto desc : info.out) {
+                if (desc != partner) {
+                    p_trim->visit(desc, vtx, true);
+                }
+            }
+            for (auto actr : info.in) {
+                if (actr != partner) {
+                    p_trim->visit(actr, vtx, false);
                 }
-                info.out.clear();
             }
+            info.out.clear();
+            info.in.clear();
 
-            if(info.out.empty()) {
-                info.comp_id = vtx;
-                info.active = false;
+            // the partner already qualified when it asked, so echoing retires it too
+            p_pair->visit(partner, vtx, in_side);
+            p_trim->drain();
+            p_pair->drain();
+        }
+    };
 
-                for (auto actr : info.in) {
-                    p_vertex_map->async_visit(actr, trim_vtx(), vtx, false);
+    std::vector<VertexId> touched;
+    LocalFirstFrontier<map_type, trim_vtx, VertexId, bool> trim(vertex_map);
+    LocalFirstFrontier<map_type, trim_pair, VertexId, bool> pair(vertex_map);
+    p_trim = &trim;
+    p_pair = &pair;
+    p_touched = &touched;
+
+    auto check_trivial = [] (const VertexId& vtx, Info& info) {
+        if (info.active) {
+            trim_vtx::retire_if_trivial(vtx, info);
+            p_trim->drain();
+        }
+    };
+
+    const bool sweep = work == nullptr || work->all;
+    std::vector<VertexId> candidates;
+
+    if (sweep) {
+        vertex_map.local_for_all(check_trivial);
+    } else {
+        candidates = work->take();
+        for (VertexId vtx : candidates) {
+            vertex_map.local_visit(vtx, check_trivial);
+        }
+    }
+
+    timed_barrier(world);
+
+    if (pairs) {
+        auto check_pair = [] (const VertexId& vtx, Info& info) {
+            if (!info.active) {
+                return;
+            }
+
+            if (info.in.size() == 1 && info.out.contains(*info.in.begin())) {
+                p_pair->visit(*info.in.begin(), vtx, true);
+            }
+            if (info.out.size() == 1 && info.in.contains(*info.out.begin())) {
+                p_pair->visit(*info.out.begin(), vtx, false);
+            }
+            p_pair->drain();
+        };
+
+        bool first_round = true;
+        do {
+            if (first_round && sweep) {
+                touched.clear();
+                vertex_map.local_for_all(check_pair);
+            } else {
+                BasicTrimWorklist<VertexId> round;
+                round.all = false;
+                round.vertices.swap(touched);
+                if (first_round) {
+                    round.vertices.insert(round.vertices.end(), candidates.begin(), candidates.end());
+                }
+                for (VertexId vtx : round.take()) {
+                    vertex_map.local_visit(vtx, check_pair);
                 }
-                info.in.clear();
             }
-        }
-    });
+            first_round = false;
+
+            timed_barrier(world);
+        } while (ygm::sum(touched.size(), world) > 0);
+    }
 
-    world.barrier();
-}
\ No newline at end of file
+    if (work) {
+        work->all = false;
+    }
+}
@@ -0,0 +1,236 @@
+#pragma once
+#include <ygm/comm.hpp>
+#include <ygm/container/map.hpp>
+#include <ygm/detail/collective.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "condensation.hpp"
+#include "dcsc.hpp"
+#include "graph_util.hpp"
+#include "local_first.hpp"
+#include "phase_stats.hpp"
+
+/**
+ * @brief Incremental SCC maintenance of a converged vertex map under edge insertions.
+ *
+ * A batch of inserted edges can only merge existing SCCs, and only those on
+ * a cycle it closes in the condensation DAG: an SCC L joins a merged one
+ * iff, in the DAG plus the inserted cross edges, L is reachable from the
+ * head of some inserted edge and reaches the tail of some inserted edge.
+ * insert_edges() therefore
+ *
+ *   1. relabels the batch with the endpoints' comp_ids (new vertices become
+ *      singleton SCCs) and drops the insertions inside an SCC,
+ *   2. builds the DAG plus the remaining insertions as a vertex map over the
+ *      SCC labels, marks that region by one forward search from the heads
+ *      and one backward search from the tails, and shears it off,
+ *   3. runs the normal DCSC iterations on the region only, the rest of the
+ *      DAG being inactive singletons,
+ *   4. renames the SCC label of every vertex whose SCC was merged, asking
+ *      the owner of each distinct label once per rank.
+ *
+ * Only the DAG and the touched region are worked on; the vertex map itself
+ * is visited twice, for the labels. The DAG is an input because DCSC has
+ * already deleted the edges between SCCs.
+ */
+struct IncrementalResult {
+    uint64_t cross_edges = 0;   // inserted edges between two different SCCs
+    uint64_t region = 0;        // SCCs re-examined
+    uint64_t merged = 0;        // SCCs absorbed into another one
+    size_t iterations = 0;
+};
+
+/**
+ * @brief Collectively apply a batch of edge insertions to the converged graph.
+ *
+ * for_each_dag_edge(fn) and for_each_insert(fn) call fn(src, dst) for this
+ * rank's share of the condensation DAG (in SCC labels, as
+ * write_condensation() stores them) and of the inserted edges. With dag_out
+ * the updated DAG is built into it.
+ */
+template <typename VertexId, typename Info, typename DagSource, typename InsertSource>
+inline IncrementalResult insert_edges(ygm::comm& world, ygm::container::map<VertexId, Info>& graph, DagSource&& for_each_dag_edge,
+                                      InsertSource&& for_each_insert, PhaseRecorder& stats, const DcscConfig& config,
+                                      ygm::container::map<VertexId, Info>* dag_out = nullptr,
+                                      size_t batch_size = kDefaultEdgeBatch) {
+    using map_type = ygm::container::map<VertexId, Info>;
+    using edge = std::pair<VertexId, VertexId>;
+
+    if (ygm::sum(local_active_count(graph), world) != 0) {
+        throw std::runtime_error("edges can only be inserted into a converged graph");
+    }
+
+    IncrementalResult result;
+
+    // 1. vertices first seen in the batch are SCCs of their own
+    for_each_insert([&graph](VertexId src, VertexId dst) {
+        auto adopt = [](const VertexId& vtx, Info& info) {
+            if (info.comp_id == VertexId(-1)) {
+                info.comp_id = vtx;
+                info.active = false;
+            }
+        };
+        graph.async_visit(src, adopt);
+        graph.async_visit(dst, adopt);
+    });
+    world.barrier();
+
+    // a self-loop per surviving label keeps the SCCs without DAG edges in dag_out, as build_condensation does
+    auto surviving_labels = [&graph] {
+        std::vector<VertexId> survivors;
+        graph.local_for_all([&survivors](const VertexId& vtx, const Info& info) {
+            if (info.comp_id == vtx) {
+                survivors.push_back(vtx);
+            }
+        });
+        return survivors;
+    };
+
+    std::vector<edge> inserted = cross_component_edges(world, graph, for_each_insert);
+    result.cross_edges = ygm::sum(inserted.size(), world);
+    if (result.cross_edges == 0) {
+        if (dag_out) {
+            std::vector<VertexId> survivors = surviving_labels();
+            create_vertex_map_from_edges(world, [&](auto fn) {
+                for_each_dag_edge(fn);
+                for (VertexId label : survivors) {
+                    fn(label, label);
+                }
+            }, *dag_out, batch_size);
+        }
+        return result;
+    }
+
+    // 2. the DAG with the new edges; its edges are kept to derive the next DAG
+    std::vector<edge> dag_edges;
+    map_type region(world);
+    create_vertex_map_from_edges(world, [&](auto fn) {
+        for_each_dag_edge([&fn, &dag_edges](VertexId src, VertexId dst) {
+            dag_edges.emplace_back(src, dst);
+            fn(src, dst);
+        });
+        for (const auto& [src, dst] : inserted) {
+            dag_edges.emplace_back(src, dst);
+            fn(src, dst);
+        }
+    }, region, batch_size);
+
+    struct reach_fwd;
+    struct reach_bwd;
+    static LocalFirstFrontier<map_type, reach_fwd>* p_fwd;
+    static LocalFirstFrontier<map_type, reach_bwd>* p_bwd;
+
+    struct reach_fwd {
+        void operator()(const VertexId& label, Info& info) {
+            if (info.mark_desc) {
+                return;
+            }
+            info.mark_desc = true;
+            for (auto desc : info.out) {
+                p_fwd->visit(desc);
+            }
+            p_fwd->drain();
+        }
+    };
+
+    struct reach_bwd {
+        void operator()(const VertexId& label, Info& info) {
+            if (info.mark_pred) {
+                return;
+            }
+            info.mark_pred = true;
+            for (auto actr : info.in) {
+                p_bwd->visit(actr);
+            }
+            p_bwd->drain();
+        }
+    };
+
+    LocalFirstFrontier<map_type, reach_fwd> fwd(region);
+    LocalFirstFrontier<map_type, reach_bwd> bwd(region);
+    p_fwd = &fwd;
+    p_bwd = &bwd;
+    for (const auto& [tail, head] : inserted) {
+        fwd.visit(head);
+        fwd.drain();
+        bwd.visit(tail);
+        bwd.drain();
+    }
+    timed_barrier(world);
+
+    // an edge leaving the region joins two differently marked labels, so the shear drops it
+    shear_edges(world, region);
+
+    region.local_for_all([](const VertexId& label, Info& info) {
+        if (info.mark_pred && info.mark_desc) {
+            reset_iteration_state(info);
+        } else {
+            info.comp_id = label;
+            info.active = false;
+        }
+    });
+    result.region = ygm::sum(local_active_count(region), world);
+
+    // 3. the merged SCCs, labeled by one of the labels they absorb
+    result.iterations = run_dcsc_iterations(world, region, stats, config, 0, result.region, [](size_t, size_t) {});
+
+    // 4. rename the labels this rank's vertices carry
+    static ygm::comm* p_world;
+    static std::unordered_map<VertexId, VertexId>* p_renamed;
+    std::unordered_map<VertexId, VertexId> renamed;
+    p_world = &world;
+    p_renamed = &renamed;
+
+    std::vector<VertexId> labels;
+    graph.local_for_all([&labels](const VertexId& vtx, const Info& info) { labels.push_back(info.comp_id); });
+    std::sort(labels.begin(), labels.end());
+    labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+
+    uint64_t merged = 0;
+    region.local_for_all([&merged](const VertexId& label, const Info& info) { merged += info.comp_id != label; });
+    result.merged = ygm::sum(merged, world);
+
+    for (VertexId label : labels) {
+        region.async_visit(label, [](const VertexId& label, Info& info, int asker) {
+            // labels outside the DAG (isolated SCCs) get a fresh entry with no comp_id here
+            if (info.comp_id != label && info.comp_id != VertexId(-1)) {
+                p_world->async(asker, [](VertexId label, VertexId comp) { p_renamed->emplace(label, comp); }, label, info.comp_id);
+            }
+        }, world.rank());
+    }
+    world.barrier();
+
+    graph.local_for_all([&renamed](const VertexId& vtx, Info& info) {
+        auto it = renamed.find(info.comp_id);
+        if (it != renamed.end()) {
+            info.comp_id = it->second;
+        }
+    });
+
+    if (dag_out) {
+        std::vector<edge> next = cross_component_edges(world, region, [&dag_edges](auto fn) {
+            for (const auto& [src, dst] : dag_edges) {
+                fn(src, dst);
+            }
+        });
+        std::vector<edge>().swap(dag_edges);
+        std::vector<VertexId> survivors = surviving_labels();
+        create_vertex_map_from_edges(world, [&next, &survivors](auto fn) {
+            for (const auto& [src, dst] : next) {
+                fn(src, dst);
+            }
+            for (VertexId label : survivors) {
+                fn(label, label);
+            }
+        }, *dag_out, batch_size);
+    }
+    world.barrier();
+
+    return result;
+}
@@ -0,0 +1,314 @@
+#pragma once
+#include <ygm/comm.hpp>
+#include <ygm/container/map.hpp>
+#include <ygm/detail/collective.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <cereal/types/utility.hpp>
+#include <cereal/types/vector.hpp>
+
+#include "binary_edgelist.hpp"
+#include "csr_graph.hpp"
+#include "graph_util.hpp"
+
+/**
+ * @brief Output stage: the vertex -> SCC assignment and SCC size statistics.
+ *
+ * write_scc_membership() has every rank write the (vertex, comp_id) pairs of
+ * its own vertices to a shard of its own, so nothing is gathered. Ids are
+ * written as they appear in the input edge list (the +1 shift undone, and
+ * a partitioner's relabeling through CsrGraph::input_ids); an SCC is
+ * labeled by the id of one of its vertices.
+ *
+ * summarize_scc_sizes() counts each SCC on the rank that owns its label.
+ * Every rank sorts its local labels and sends one (label, count) pair per
+ * run, packed into batches per owner, so the owners only hold entries for
+ * the SCCs whose label they own and no second vertex-sized map is built.
+ * The histogram and the top-k list are then reduced across ranks.
+ */
+
+namespace detail {
+
+/// fn(vtx, comp_id) for every local vertex.
+template <typename VertexId, typename Info, typename Function>
+inline void for_all_local_components(ygm::container::map<VertexId, Info>& vertex_map, Function fn) {
+    vertex_map.local_for_all([&fn](const VertexId& vtx, const Info& info) { fn(vtx, info.comp_id); });
+}
+
+template <typename Function>
+inline void for_all_local_components(CsrGraph& graph, Function fn) {
+    for (uint32_t l = 0; l < graph.num_local(); ++l) {
+        if (graph.present[l]) {
+            fn(graph.global_id(l), graph.comp_id[l]);
+        }
+    }
+}
+
+/// fn(vtx, comp_id) for every local vertex in the ids of the input edge list (still shifted up by one). Collective.
+template <typename VertexId, typename Info, typename Function>
+inline void for_all_input_components(ygm::comm& world, ygm::container::map<VertexId, Info>& vertex_map, Function fn) {
+    for_all_local_components(vertex_map, fn);
+}
+
+/// A CsrGraph built from relabeled edges maps its vertices back through input_ids; each label is looked up once at its owner.
+template <typename Function>
+inline void for_all_input_components(ygm::comm& world, CsrGraph& graph, Function fn) {
+    if (graph.input_ids.empty()) {
+        for_all_local_components(graph, fn);
+        return;
+    }
+
+    static CsrGraph* p_graph;
+    static std::vector<std::pair<uint32_t, uint32_t>>* p_labels;
+    p_graph = &graph;
+    std::vector<std::pair<uint32_t, uint32_t>> labels;   // (label, its input id), sorted by label
+    p_labels = &labels;
+
+    std::vector<uint32_t> remote;
+    for (uint32_t l = 0; l < graph.num_local(); ++l) {
+        if (graph.present[l] && graph.owner(graph.comp_id[l]) != world.rank()) {
+            remote.push_back(graph.comp_id[l]);
+        }
+    }
+    std::sort(remote.begin(), remote.end());
+    remote.erase(std::unique(remote.begin(), remote.end()), remote.end());
+
+    auto lookup = [](uint32_t label, int from) {
+        auto answer = [](uint32_t label, uint32_t input) { p_labels->emplace_back(label, input); };
+        p_graph->comm().async(from, answer, label, p_graph->input_ids[p_graph->local_index(label)]);
+    };
+    for (uint32_t label : remote) {
+        world.async(graph.owner(label), lookup, label, world.rank());
+    }
+    world.barrier();
+    std::sort(labels.begin(), labels.end());
+
+    for (uint32_t l = 0; l < graph.num_local(); ++l) {
+        if (!graph.present[l]) {
+            continue;
+        }
+        uint32_t comp = graph.comp_id[l];
+        uint32_t input = graph.owner(comp) == world.rank()
+            ? graph.input_ids[graph.local_index(comp)]
+            : std::lower_bound(labels.begin(), labels.end(), std::make_pair(comp, uint32_t(0)))->second;
+        fn(graph.input_ids[l], input);
+    }
+}
+
+/// Rank that owns vertex vtx, and with it the SCC labeled vtx.
+template <typename VertexId, typename Info>
+inline int vertex_owner(ygm::container::map<VertexId, Info>& vertex_map, VertexId vtx) {
+    return vertex_map.partitioner.owner(vtx);
+}
+
+inline int vertex_owner(CsrGraph& graph, uint32_t vtx) { return graph.owner(vtx); }
+
+/// Input id (shifted up by one) of a vertex this rank owns, undoing a partitioner's relabeling.
+template <typename VertexId, typename Info>
+inline VertexId input_id(ygm::container::map<VertexId, Info>& vertex_map, VertexId vtx) {
+    return vtx;
+}
+
+inline uint32_t input_id(CsrGraph& graph, uint32_t vtx) {
+    return graph.input_ids.empty() ? vtx : graph.input_ids[graph.local_index(vtx)];
+}
+
+inline std::filesystem::path membership_shard(const std::filesystem::path& dir, int rank, bool binary) {
+    return dir / ("part-" + std::to_string(rank) + (binary ? ".bin" : ".txt"));
+}
+
+} // namespace detail
+
+struct SccSizeSummary {
+    static constexpr size_t kBuckets = 64;
+
+    uint64_t num_sccs = 0;
+    uint64_t largest = 0;
+    /// histogram[b] counts the SCCs with 2^b <= size < 2^(b+1).
+    std::vector<uint64_t> histogram = std::vector<uint64_t>(kBuckets, 0);
+    /// (size, input id of the label) of the largest SCCs, largest first, equal sizes by label.
+    std::vector<std::pair<uint64_t, uint64_t>> top;
+};
+
+/// Collectively compute the SCC count, largest size, size histogram and the top_k largest SCCs.
+template <typename Graph>
+inline SccSizeSummary summarize_scc_sizes(ygm::comm& world, Graph& graph, size_t top_k = 0) {
+    using vertex_type = vertex_id_t<Graph>;
+    using sized_label = std::pair<uint64_t, uint64_t>;
+
+    static std::vector<std::pair<vertex_type, uint64_t>>* p_counts;
+    std::vector<std::pair<vertex_type, uint64_t>> counts;
+    p_counts = &counts;
+
+    // one (label, count) pair per distinct local label, packed per owner
+    {
+        std::vector<vertex_type> labels;
+        detail::for_all_local_components(graph, [&labels](vertex_type vtx, vertex_type comp) { labels.push_back(comp); });
+        std::sort(labels.begin(), labels.end());
+
+        std::vector<std::vector<uint64_t>> batches(world.size());
+        auto send = [&world, &batches](int dest) {
+            if (batches[dest].empty()) {
+                return;
+            }
+            world.async(dest, [](const std::vector<uint64_t>& packed) {
+                for (size_t i = 0; i + 1 < packed.size(); i += 2) {
+                    p_counts->emplace_back(vertex_type(packed[i]), packed[i + 1]);
+                }
+            }, batches[dest]);
+            batches[dest].clear();
+        };
+
+        for (size_t first = 0; first < labels.size();) {
+            size_t last = first + 1;
+            while (last < labels.size() && labels[last] == labels[first]) {
+                ++last;
+            }
+            int dest = detail::vertex_owner(graph, labels[first]);
+            batches[dest].push_back(labels[first]);
+            batches[dest].push_back(last - first);
+            if (batches[dest].size() >= 2 * kDefaultEdgeBatch) {
+                send(dest);
+            }
+            first = last;
+        }
+        for (int dest = 0; dest < world.size(); ++dest) {
+            send(dest);
+        }
+    }
+    world.barrier();
+
+    // larger first, then smaller label; the heap keeps the worst of the current top at its front
+    auto better = [](const sized_label& a, const sized_label& b) {
+        return a.first > b.first || (a.first == b.first && a.second < b.second);
+    };
+
+    SccSizeSummary summary;
+    std::sort(counts.begin(), counts.end());
+    for (size_t first = 0; first < counts.size();) {
+        uint64_t size = 0;
+        size_t last = first;
+        for (; last < counts.size() && counts[last].first == counts[first].first; ++last) {
+            size += counts[last].second;
+        }
+
+        ++summary.num_sccs;
+        summary.largest = std::max(summary.largest, size);
+        ++summary.histogram[63 - __builtin_clzll(size)];
+        if (top_k > 0) {
+            // the counts meet at the label's owner, which knows its input id
+            summary.top.emplace_back(size, uint64_t(detail::input_id(graph, counts[first].first)) - 1);
+            std::push_heap(summary.top.begin(), summary.top.end(), better);
+            if (summary.top.size() > top_k) {
+                std::pop_heap(summary.top.begin(), summary.top.end(), better);
+                summary.top.pop_back();
+            }
+        }
+        first = last;
+    }
+    std::vector<std::pair<vertex_type, uint64_t>>().swap(counts);
+    std::sort(summary.top.begin(), summary.top.end(), better);
+
+    summary.num_sccs = ygm::sum(summary.num_sccs, world);
+    summary.largest = ygm::max(summary.largest, world);
+    summary.histogram = world.all_reduce(summary.histogram, [](const std::vector<uint64_t>& a, const std::vector<uint64_t>& b) {
+        std::vector<uint64_t> sum(a);
+        for (size_t i = 0; i < sum.size(); ++i) {
+            sum[i] += b[i];
+        }
+        return sum;
+    });
+    if (top_k > 0) {
+        summary.top = world.all_reduce(summary.top, [top_k, better](const std::vector<sized_label>& a, const std::vector<sized_label>& b) {
+            std::vector<sized_label> merged(a.size() + b.size());
+            std::merge(a.begin(), a.end(), b.begin(), b.end(), merged.begin(), better);
+            merged.resize(std::min(merged.size(), top_k));
+            return merged;
+        });
+    }
+
+    return summary;
+}
+
+/**
+ * @brief Collectively write every vertex's SCC label into dir, one shard per rank. Returns the pairs written.
+ *
+ * Rank r writes dir/part-<r>.txt, one "vertex comp" line per vertex, or
+ * with binary set dir/part-<r>.bin, a binary edge list (BinaryEdgeListHeader
+ * followed by packed (vertex, comp) id pairs of the graph's id width) that
+ * for_all_binary_edges can read back. Shards of an earlier run are removed.
+ */
+template <typename Graph>
+inline uint64_t write_scc_membership(ygm::comm& world, Graph& graph, const std::string& dir, bool binary) {
+    namespace fs = std::filesystem;
+    using vertex_type = vertex_id_t<Graph>;
+    constexpr size_t kFlushBytes = size_t(1) << 20;
+
+    if (world.rank0()) {
+        fs::create_directories(dir);
+        for (const auto& entry : fs::directory_iterator(dir)) {
+            if (entry.path().filename().string().rfind("part-", 0) == 0) {
+                fs::remove(entry.path());
+            }
+        }
+    }
+    world.barrier();
+
+    const fs::path shard = detail::membership_shard(dir, world.rank(), binary);
+    std::ofstream out(shard, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("cannot create SCC output " + shard.string());
+    }
+
+    BinaryEdgeListHeader header;
+    header.id_bytes = sizeof(vertex_type);
+    if (binary) {
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    std::string buffer;
+    buffer.reserve(kFlushBytes + 64);
+    uint64_t written = 0;
+    detail::for_all_input_components(world, graph, [&](vertex_type vtx, vertex_type comp) {
+        const vertex_type pair[2] = {vertex_type(vtx - 1), vertex_type(comp - 1)};
+        if (binary) {
+            buffer.append(reinterpret_cast<const char*>(pair), sizeof(pair));
+        } else {
+            char line[48];
+            char* end = std::to_chars(line, line + sizeof(line), pair[0]).ptr;
+            *end++ = ' ';
+            end = std::to_chars(end, line + sizeof(line), pair[1]).ptr;
+            *end++ = '\n';
+            buffer.append(line, end);
+        }
+        ++written;
+        if (buffer.size() >= kFlushBytes) {
+            out.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+    });
+    out.write(buffer.data(), buffer.size());
+
+    if (binary) {
+        header.num_edges = written;
+        header.num_vertices = written;
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    out.flush();
+    if (!out) {
+        throw std::runtime_error("short write to SCC output " + shard.string());
+    }
+    out.close();
+
+    return ygm::sum(written, world);
+}
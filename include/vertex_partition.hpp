@@ -0,0 +1,275 @@
+#pragma once
+#include <ygm/comm.hpp>
+#include <ygm/detail/collective.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "graph_util.hpp"
+
+/**
+ * @brief Output of the load-time partitioning stage.
+ *
+ * edges holds this rank's share of the relabeled edge list, ready for
+ * create_vertex_map_from_edges / create_csr_graph_from_edges. New ids are
+ * dense per part: the lidx-th vertex placed in part p becomes lidx * P + p,
+ * so under CsrGraph's cyclic layout every part lands whole on rank p and
+ * the id range is contiguous. original[lidx] is the input id of the new
+ * vertex lidx * P + rank.
+ *
+ * The edge-cut fractions are measured against the owner function of the
+ * graph the edges are loaded into, on the input ids and on the new ones.
+ */
+struct VertexPartition {
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    std::vector<uint32_t> original;
+    double cut_before = 0;
+    double cut_after = 0;
+};
+
+namespace detail {
+
+// Per-rank scratch for the partitioner. Vertex v is handled by rank v % P,
+// which keeps its undirected neighbor list in CSR form plus the last known
+// part of every remote neighbor.
+struct PartitionState {
+    ygm::comm* world = nullptr;
+    int rank = 0;
+    int nranks = 1;
+
+    int owner(uint32_t vtx) const { return vtx % nranks; }
+
+    std::vector<std::pair<uint32_t, uint32_t>> input;      // edges read by this rank
+    std::vector<std::pair<uint32_t, uint32_t>> nbr_pairs;  // (owned vertex, neighbor)
+
+    std::vector<uint32_t> vertices;   // owned vertices, sorted
+    std::vector<uint64_t> offsets;
+    std::vector<uint32_t> nbrs;
+    std::vector<int> part;
+    std::vector<int> published;       // part last sent to the neighbors' ranks
+    std::vector<uint32_t> new_id;
+    std::unordered_map<uint32_t, int> ghost_part;
+
+    VertexPartition* result = nullptr;
+
+    size_t index_of(uint32_t vtx) const {
+        return std::lower_bound(vertices.begin(), vertices.end(), vtx) - vertices.begin();
+    }
+
+    int part_of(uint32_t vtx) const {
+        if (owner(vtx) == rank) {
+            return part[index_of(vtx)];
+        }
+        auto it = ghost_part.find(vtx);
+        return it == ghost_part.end() ? -1 : it->second;
+    }
+
+    void build_neighbors() {
+        std::sort(nbr_pairs.begin(), nbr_pairs.end());
+        nbr_pairs.erase(std::unique(nbr_pairs.begin(), nbr_pairs.end()), nbr_pairs.end());
+
+        for (const auto& [v, u] : nbr_pairs) {
+            if (vertices.empty() || vertices.back() != v) {
+                vertices.push_back(v);
+                offsets.push_back(nbrs.size());
+            }
+            nbrs.push_back(u);
+        }
+        offsets.push_back(nbrs.size());
+        std::vector<std::pair<uint32_t, uint32_t>>().swap(nbr_pairs);
+
+        part.assign(vertices.size(), -1);
+        published.assign(vertices.size(), -1);
+        new_id.assign(vertices.size(), uint32_t(-1));
+    }
+};
+
+inline std::vector<uint64_t> part_sizes(ygm::comm& world, const PartitionState& state) {
+    std::vector<uint64_t> sizes(state.nranks, 0);
+    for (int p : state.part) {
+        if (p >= 0) {
+            sizes[p]++;
+        }
+    }
+    return world.all_reduce(sizes, [](const std::vector<uint64_t>& a, const std::vector<uint64_t>& b) {
+        std::vector<uint64_t> sum(a);
+        for (size_t i = 0; i < sum.size(); ++i) {
+            sum[i] += b[i];
+        }
+        return sum;
+    });
+}
+
+} // namespace detail
+
+/**
+ * @brief Restreaming Linear Deterministic Greedy (LDG) partitioner with relabeling.
+ *
+ * Each rank streams the vertices it owns and places every vertex in the part
+ * holding most of its already-placed neighbors, weighted by the remaining
+ * capacity (1 - |part| / C) so parts stay balanced. A vertex with no placed
+ * neighbors stays on its current rank. All ranks stream at once, so each
+ * local placement is charged P times against the part sizes to approximate
+ * the others' concurrent choices; parts are exchanged between passes and
+ * 'rounds' passes refine the result.
+ *
+ * Parts only pay off in a graph that places vertex v on rank v % P, as
+ * CsrGraph does. owner is that graph's owner function; both cuts are
+ * counted against it.
+ */
+template <typename Owner>
+inline VertexPartition partition_vertices(ygm::comm &world, const std::string& edgelist_file, Owner owner, int rounds = 3) {
+    static detail::PartitionState* p_state;
+
+    detail::PartitionState state;
+    state.world = &world;
+    state.rank = world.rank();
+    state.nranks = world.size();
+    p_state = &state;
+
+    VertexPartition result;
+    state.result = &result;
+
+    // Gather each owned vertex's undirected neighbor list.
+    for_all_edges(world, edgelist_file, [&world, &state](uint32_t src, uint32_t dst) {
+        auto add_nbr = [](uint32_t vtx, uint32_t nbr) {
+            p_state->nbr_pairs.emplace_back(vtx, nbr);
+        };
+
+        state.input.emplace_back(src, dst);
+        world.async(state.owner(src), add_nbr, src, dst);
+        world.async(state.owner(dst), add_nbr, dst, src);
+    });
+
+    world.barrier();
+
+    state.build_neighbors();
+
+    const uint64_t num_vertices = ygm::sum(uint64_t(state.vertices.size()), world);
+    const double capacity = double(num_vertices) / state.nranks + 1.0;
+
+    std::vector<uint32_t> nbr_parts;
+    std::vector<int> dest_ranks;
+
+    for (int round = 0; round < rounds; ++round) {
+        std::vector<uint64_t> sizes = detail::part_sizes(world, state);
+
+        for (size_t i = 0; i < state.vertices.size(); ++i) {
+            nbr_parts.clear();
+            for (uint64_t e = state.offsets[i]; e < state.offsets[i + 1]; ++e) {
+                int p = state.part_of(state.nbrs[e]);
+                if (p >= 0) {
+                    nbr_parts.push_back(p);
+                }
+            }
+            std::sort(nbr_parts.begin(), nbr_parts.end());
+
+            int best = state.rank;
+            double best_score = 0;
+            for (size_t j = 0; j < nbr_parts.size();) {
+                size_t k = j;
+                while (k < nbr_parts.size() && nbr_parts[k] == nbr_parts[j]) {
+                    ++k;
+                }
+                int p = nbr_parts[j];
+                double score = double(k - j) * (1.0 - double(sizes[p]) / capacity);
+                if (score > best_score || (score == best_score && p == state.rank)) {
+                    best = p;
+                    best_score = score;
+                }
+                j = k;
+            }
+
+            int old = state.part[i];
+            if (old != best) {
+                if (old >= 0) {
+                    sizes[old] -= std::min<uint64_t>(sizes[old], state.nranks);
+                }
+                sizes[best] += state.nranks;
+                state.part[i] = best;
+            }
+        }
+
+        // Publish changed parts to every rank that holds one of our neighbors.
+        auto set_ghost = [](uint32_t vtx, int part) {
+            p_state->ghost_part[vtx] = part;
+        };
+
+        for (size_t i = 0; i < state.vertices.size(); ++i) {
+            if (state.published[i] == state.part[i]) {
+                continue;
+            }
+            state.published[i] = state.part[i];
+
+            dest_ranks.clear();
+            for (uint64_t e = state.offsets[i]; e < state.offsets[i + 1]; ++e) {
+                int r = state.owner(state.nbrs[e]);
+                if (r != state.rank) {
+                    dest_ranks.push_back(r);
+                }
+            }
+            std::sort(dest_ranks.begin(), dest_ranks.end());
+            dest_ranks.erase(std::unique(dest_ranks.begin(), dest_ranks.end()), dest_ranks.end());
+
+            for (int r : dest_ranks) {
+                world.async(r, set_ghost, state.vertices[i], state.part[i]);
+            }
+        }
+
+        world.barrier();
+    }
+
+    // Relabel: every part hands out dense local indices to the vertices placed in it.
+    auto claim_id = [](uint32_t vtx, int from) {
+        auto& original = p_state->result->original;
+        uint32_t id = uint32_t(original.size()) * p_state->nranks + p_state->rank;
+        original.push_back(vtx);
+
+        p_state->world->async(from, [](uint32_t vtx, uint32_t id) {
+            p_state->new_id[p_state->index_of(vtx)] = id;
+        }, vtx, id);
+    };
+
+    for (size_t i = 0; i < state.vertices.size(); ++i) {
+        world.async(state.part[i], claim_id, state.vertices[i], state.rank);
+    }
+
+    world.barrier();
+
+    // Rewrite both endpoints of every input edge; the owner of dst keeps the result.
+    auto relabel_src = [](uint32_t src, uint32_t dst) {
+        const auto& s = *p_state;
+        s.world->async(s.owner(dst), [](uint32_t new_src, uint32_t dst) {
+            const auto& s = *p_state;
+            s.result->edges.emplace_back(new_src, s.new_id[s.index_of(dst)]);
+        }, s.new_id[s.index_of(src)], dst);
+    };
+
+    size_t local_cut = 0;
+    for (const auto& [src, dst] : state.input) {
+        local_cut += owner(src) != owner(dst);
+        world.async(state.owner(src), relabel_src, src, dst);
+    }
+    const size_t local_edges = state.input.size();
+
+    world.barrier();
+
+    std::vector<std::pair<uint32_t, uint32_t>>().swap(state.input);
+    const size_t num_edges = ygm::sum(local_edges, world);
+
+    size_t relabeled_cut = 0;
+    for (const auto& [src, dst] : result.edges) {
+        relabeled_cut += owner(src) != owner(dst);
+    }
+
+    if (num_edges > 0) {
+        result.cut_before = double(ygm::sum(local_cut, world)) / num_edges;
+        result.cut_after = double(ygm::sum(relabeled_cut, world)) / num_edges;
+    }
+
+    return result;
+}
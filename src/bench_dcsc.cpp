@@ -0,0 +1,263 @@
+#include "graph_util.hpp"
+#include "dcsc.hpp"
+#include "graph_generators.hpp"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+// Benchmark DCSC on generated graphs: one JSON record per trial, appended to
+// --output (or printed on rank 0), for tracking runs across commits and machines.
+
+struct BenchOptions {
+    GeneratorParams gen;
+    std::string graph = "map";
+    std::string adjacency = "vector";
+    size_t batch_size = kDefaultEdgeBatch;
+    uint32_t hub_degree = 0;
+    unsigned ids = 32;
+    DcscConfig dcsc;
+    int trials = 1;
+    std::string label;
+    std::string output;
+};
+
+struct TrialResult {
+    double construction_seconds = 0;
+    double scc_seconds = 0;
+    size_t iterations = 0;
+    uint64_t sccs = 0;
+    uint64_t largest_scc = 0;
+};
+
+/// Peak resident set size of this process in KiB.
+inline uint64_t max_rss_kib() {
+    struct rusage usage;
+    ::getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+template <typename Graph, typename Build>
+TrialResult run_trial(ygm::comm &world, const DcscConfig& config, Build build)
+{
+    TrialResult result;
+
+    world.barrier();
+    double start = wall_seconds();
+    Graph graph(world);
+    build(graph);
+    world.barrier();
+    result.construction_seconds = wall_seconds() - start;
+
+    PhaseRecorder stats(world, false);
+    start = wall_seconds();
+    result.iterations = run_dcsc_iterations(world, graph, stats, config, 0, 1, [](size_t, size_t) {});
+    result.scc_seconds = wall_seconds() - start;
+
+    result.sccs = count_sccs(world, graph);
+    result.largest_scc = count_largest_scc(world, graph);
+
+    return result;
+}
+
+template <typename Graph, typename Build>
+int run_bench(ygm::comm &world, const BenchOptions& opts, Build build)
+{
+    char host[256] = {0};
+    ::gethostname(host, sizeof(host) - 1);
+
+    const GeneratorParams& gen = opts.gen;
+    int status = 0;
+
+    for (int trial = 0; trial < opts.trials; ++trial) {
+        TrialResult r = run_trial<Graph>(world, opts.dcsc, build);
+
+        uint64_t rss_max = ygm::max(max_rss_kib(), world);
+        uint64_t rss_sum = ygm::sum(max_rss_kib(), world);
+
+        // the planted generator knows the answer
+        bool verified = true;
+        if (gen.kind == "planted") {
+            uint64_t largest = (gen.num_vertices() + gen.sccs - 1) / gen.sccs;
+            verified = r.sccs == gen.sccs && r.largest_scc == largest;
+            if (!verified) {
+                status = 1;
+            }
+        }
+
+        std::ostringstream record;
+        record.precision(9);
+        record << "{\"label\": \"" << opts.label << "\", \"host\": \"" << host << "\", \"ranks\": " << world.size()
+               << ", \"generator\": \"" << gen.kind << "\", \"scale\": " << gen.scale
+               << ", \"edge_factor\": " << gen.edge_factor << ", \"seed\": " << gen.seed
+               << ", \"graph\": \"" << opts.graph << "\", \"adjacency\": \"" << opts.adjacency << "\""
+               << ", \"batch_size\": " << opts.batch_size << ", \"fwbw\": " << (opts.dcsc.fwbw_opening ? "true" : "false")
+               << ", \"engine\": \"" << opts.dcsc.engine << "\", \"pivots\": \"" << opts.dcsc.pivots << "\", \"trim2\": " << (opts.dcsc.trim2 ? "true" : "false")
+               << ", \"pipeline\": " << (opts.dcsc.pipelined ? "true" : "false")
+               << ", \"push_pull\": " << (opts.dcsc.push_pull ? "true" : "false")
+               << ", \"compact\": " << opts.dcsc.compact_below
+               << ", \"hub_degree\": " << opts.hub_degree << ", \"ids\": " << opts.ids
+               << ", \"trial\": " << trial
+               << ", \"vertices\": " << gen.num_vertices() << ", \"edges\": " << gen.num_edges()
+               << ", \"construction_seconds\": " << r.construction_seconds << ", \"scc_seconds\": " << r.scc_seconds
+               << ", \"iterations\": " << r.iterations << ", \"teps\": " << gen.num_edges() / r.scc_seconds
+               << ", \"sccs\": " << r.sccs << ", \"largest_scc\": " << r.largest_scc
+               << ", \"verified\": " << (gen.kind != "planted" ? "null" : verified ? "true" : "false")
+               << ", \"max_rss_kib\": " << rss_max << ", \"total_rss_kib\": " << rss_sum << "}";
+
+        if (world.rank0()) {
+            if (opts.output.empty()) {
+                std::cout << record.str() << std::endl;
+            } else {
+                std::ofstream(opts.output, std::ios::app) << record.str() << std::endl;
+            }
+            if (!verified) {
+                std::cerr << "Planted graph should have " << gen.sccs << " SCCs, found " << r.sccs << std::endl;
+            }
+        }
+    }
+
+    return status;
+}
+
+template <typename Info>
+int run_bench_map(ygm::comm &world, const BenchOptions& opts)
+{
+    return run_bench<ygm::container::map<typename Info::vertex_type, Info>>(world, opts, [&](auto& graph) {
+        create_vertex_map_from_edges(world, [&](auto fn) { for_all_generated_edges(world, opts.gen, fn); }, graph,
+                                     opts.batch_size);
+    });
+}
+
+template <typename VertexId>
+int run_bench_map_ids(ygm::comm &world, const BenchOptions& opts)
+{
+    if (opts.adjacency == "set") {
+        return run_bench_map<BasicVtxInfo<BasicSetAdjacency<VertexId>>>(world, opts);
+    } else if (opts.adjacency == "vector") {
+        return run_bench_map<BasicVtxInfo<BasicSortedVecAdjacency<VertexId>>>(world, opts);
+    } else if (opts.adjacency == "varint") {
+        return run_bench_map<BasicVtxInfo<BasicVarintAdjacency<VertexId>>>(world, opts);
+    }
+
+    if (world.rank0()) {
+        std::cerr << "Unknown adjacency '" << opts.adjacency << "'" << std::endl;
+    }
+    return 1;
+}
+
+int run_bench_csr(ygm::comm &world, const BenchOptions& opts)
+{
+    return run_bench<CsrGraph>(world, opts, [&](CsrGraph& graph) {
+        create_csr_graph_from_edges(world, [&](auto fn) { for_all_generated_edges(world, opts.gen, fn); }, graph,
+                                    opts.batch_size);
+        graph.mirror_hubs(opts.hub_degree);
+    });
+}
+
+int main(int argc, char **argv)
+{
+    ygm::comm world(&argc, &argv);
+
+    BenchOptions opts;
+    bool bad_args = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--fwbw") {
+            opts.dcsc.fwbw_opening = true;
+        } else if (arg == "--trim2") {
+            opts.dcsc.trim2 = true;
+        } else if (arg == "--pipeline") {
+            opts.dcsc.pipelined = true;
+        } else if (arg == "--push-pull") {
+            opts.dcsc.push_pull = true;
+        } else if (i + 1 >= argc) {
+            bad_args = true;
+        } else if (arg == "--generator") {
+            opts.gen.kind = argv[++i];
+        } else if (arg == "--scale") {
+            opts.gen.scale = std::stoul(argv[++i]);
+        } else if (arg == "--edge-factor") {
+            opts.gen.edge_factor = std::stoul(argv[++i]);
+        } else if (arg == "--sccs") {
+            opts.gen.sccs = std::stoull(argv[++i]);
+        } else if (arg == "--seed") {
+            opts.gen.seed = std::stoull(argv[++i]);
+        } else if (arg == "--engine") {
+            opts.dcsc.engine = argv[++i];
+        } else if (arg == "--pivots") {
+            opts.dcsc.pivots = argv[++i];
+        } else if (arg == "--graph") {
+            opts.graph = argv[++i];
+        } else if (arg == "--adjacency") {
+            opts.adjacency = argv[++i];
+        } else if (arg == "--compact") {
+            opts.dcsc.compact_below = std::stod(argv[++i]);
+        } else if (arg == "--batch-size") {
+            opts.batch_size = std::stoul(argv[++i]);
+        } else if (arg == "--hub-degree") {
+            opts.hub_degree = std::stoul(argv[++i]);
+        } else if (arg == "--ids") {
+            opts.ids = std::stoul(argv[++i]);
+        } else if (arg == "--trials") {
+            opts.trials = std::stoi(argv[++i]);
+        } else if (arg == "--label") {
+            opts.label = argv[++i];
+        } else if (arg == "--output") {
+            opts.output = argv[++i];
+        } else {
+            bad_args = true;
+        }
+    }
+
+    if (!bad_args) {
+        try {
+            opts.gen.validate();
+        } catch (const std::invalid_argument& e) {
+            if (world.rank0()) {
+                std::cerr << e.what() << std::endl;
+            }
+            return 1;
+        }
+    }
+
+    PivotPolicy policy;
+    if (bad_args || opts.trials < 1 || opts.dcsc.compact_below < 0 || opts.dcsc.compact_below > 1 || (opts.ids != 32 && opts.ids != 64) || (opts.dcsc.engine != "pivot" && opts.dcsc.engine != "coloring") ||
+        !parse_pivot_policy(opts.dcsc.pivots, policy)) {
+        if (world.rank0()) {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--generator rmat|er|planted] [--scale S] [--edge-factor E] [--sccs K] [--seed N]"
+                      << " [--graph map|csr] [--adjacency set|vector|varint] [--batch-size N] [--fwbw] [--trim2] [--pipeline] [--push-pull]"
+                      << " [--compact FRACTION] [--engine pivot|coloring] [--pivots random|degree] [--hub-degree N] [--ids 32|64] [--trials T]"
+                      << " [--label TEXT] [--output FILE]" << std::endl;
+        }
+        return 1;
+    }
+
+    if (opts.graph == "csr") {
+        if (opts.ids != 32) {
+            if (world.rank0()) {
+                std::cerr << "--ids 64 needs --graph map" << std::endl;
+            }
+            return 1;
+        }
+        return run_bench_csr(world, opts);
+    } else if (opts.graph != "map") {
+        if (world.rank0()) {
+            std::cerr << "Unknown graph '" << opts.graph << "'" << std::endl;
+        }
+        return 1;
+    }
+
+    if (opts.hub_degree > 0) {
+        if (world.rank0()) {
+            std::cerr << "--hub-degree needs --graph csr" << std::endl;
+        }
+        return 1;
+    }
+
+    return opts.ids == 64 ? run_bench_map_ids<uint64_t>(world, opts) : run_bench_map_ids<uint32_t>(world, opts);
+}
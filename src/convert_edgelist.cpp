@@ -0,0 +1,66 @@
+#include "graph_util.hpp"
+#include "binary_edgelist.hpp"
+#include <ygm/container/set.hpp>
+#include <iostream>
+
+// Convert a text edge list (.el/.txt) into the binary format read by run_dcsc.
+template <typename Id>
+int convert(ygm::comm &world, const std::string& input, const std::string& output)
+{
+    std::vector<std::pair<Id, Id>> edges;
+    ygm::container::set<Id> vertices(world);
+
+    Id min_id = std::numeric_limits<Id>::max();
+    Id max_id = 0;
+
+    for_all_text_edges<Id>(world, input, [&](Id src, Id dst) {
+        edges.emplace_back(src, dst);
+        vertices.async_insert(src);
+        vertices.async_insert(dst);
+        min_id = std::min({min_id, src, dst});
+        max_id = std::max({max_id, src, dst});
+    });
+
+    world.barrier();
+
+    BinaryEdgeListHeader header;
+    header.num_vertices = vertices.size();
+    header.min_id = ygm::min(min_id, world);
+    header.max_id = ygm::max(max_id, world);
+
+    write_binary_edgelist(world, output, edges, header);
+
+    world.cout0() << "Wrote " << ygm::sum(edges.size(), world) << " edges over " << header.num_vertices
+                  << " vertices to " << output << std::endl;
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    ygm::comm world(&argc, &argv);
+
+    int id_bits = 32;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--ids" && i + 1 < argc) {
+            id_bits = std::stoi(argv[++i]);
+        } else {
+            files.push_back(arg);
+        }
+    }
+
+    if (files.size() != 2 || (id_bits != 32 && id_bits != 64)) {
+        if (world.rank0()) {
+            std::cerr << "Usage: " << argv[0] << " [--ids 32|64] <text_edgelist> <binary_edgelist>" << std::endl;
+        }
+        return 1;
+    }
+
+    if (id_bits == 64) {
+        return convert<uint64_t>(world, files[0], files[1]);
+    }
+    return convert<uint32_t>(world, files[0], files[1]);
+}
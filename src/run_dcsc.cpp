@@ -1,72 +1,574 @@
 #include "graph_util.hpp"
-#include "scc_dcsc_regular.hpp"
+#include "dcsc.hpp"
+#include "vertex_partition.hpp"
+#include "checkpoint.hpp"
 #include "fpp_vertex_permuter.hpp"
+#include "scc_output.hpp"
+#include "condensation.hpp"
+#include "scc_incremental.hpp"
+#include "graph_batch.hpp"
+#include <filesystem>
+#include <stdexcept>
+#include <type_traits>
 #include <iostream>
 
-int main(int argc, char **argv)
+struct Options {
+    std::string graph = "map";
+    std::string adjacency = "vector";
+    std::string partition = "none";
+    size_t batch_size = kDefaultEdgeBatch;
+    std::string checkpoint_dir;
+    size_t checkpoint_every = 1;
+    std::string resume;
+    std::string stats_file;
+    bool fwbw = false;
+    bool trim2 = false;
+    bool pipeline = false;
+    bool push_pull = false;
+    double compact_below = 0;
+    uint32_t hub_degree = 0;
+    unsigned ids = 32;
+    std::string scc_out;
+    std::string scc_format = "text";
+    bool histogram = false;
+    size_t top_k = 0;
+    std::string condensation;
+    std::string insert_file;
+    std::string dag_file;
+    std::string engine = "pivot";
+    std::string pivots = "random";
+    std::string edgelist_file;
+    std::string batch_file;
+    bool batch_pack = false;
+    /// Edge lists named by batch_file, read once the arguments are parsed.
+    std::vector<std::string> batch_files;
+
+    /// Checkpoints only restore into the container, id width and adjacency they were written from.
+    std::string layout() const { return graph == "csr" ? graph : graph + (ids == 64 ? "64/" : "/") + adjacency; }
+};
+
+template <typename Graph>
+int run_dcsc(ygm::comm &world, const Options& opts, Graph& result, CheckpointHeader state)
 {
-    ygm::comm world(&argc, &argv);
+    state.layout = opts.layout();
+    if (!opts.checkpoint_dir.empty() && opts.resume.empty()) {
+        save_checkpoint(world, opts.checkpoint_dir, state, result);
+    }
 
-    if (argc != 2) {
-        if (world.rank0()) {
-            std::cerr << "Usage: " << argv[0] << " <edgelist_file>" << std::endl;
+    world.cout0() << "Starting DCSC" << std::endl;
+
+    PhaseRecorder stats(world, !opts.stats_file.empty());
+    world.stats_reset();
+
+    DcscConfig config;
+    config.verbose = true;
+    config.fwbw_opening = opts.fwbw;
+    config.engine = opts.engine;
+    config.pivots = opts.pivots;
+    config.trim2 = opts.trim2;
+    config.pipelined = opts.pipeline;
+    config.push_pull = opts.push_pull;
+    config.compact_below = opts.compact_below;
+
+    // a checkpoint holds every vertex: the compacted ones are written along with the map
+    BasicCompactedVertices<vertex_id_t<Graph>> compacted;
+    size_t end_iter = run_dcsc_iterations(world, result, stats, config, state.iteration, state.unterminated,
+                                          [&](size_t iter, size_t unterminated) {
+        if (!opts.checkpoint_dir.empty() && (unterminated == 0 || iter % opts.checkpoint_every == 0)) {
+            state.iteration = iter;
+            state.unterminated = unterminated;
+            save_checkpoint(world, opts.checkpoint_dir, state, result, &compacted);
+            world.cout0() << "Checkpointed iteration " << iter << " to " << opts.checkpoint_dir << std::endl;
         }
-        return 1;
+    }, &compacted);
+
+    // the condensation DAG, when the insertion below already produced it
+    Graph dag(world);
+    bool have_dag = false;
+
+    if constexpr (!std::is_same_v<Graph, CsrGraph>) {
+        if (!opts.insert_file.empty()) {
+            using vertex_type = vertex_id_t<Graph>;
+
+            std::vector<std::pair<vertex_type, vertex_type>> rebuilt;
+            if (opts.dag_file.empty()) {
+                rebuilt = cross_component_edges(world, result, [&](auto fn) {
+                    for_all_edges<vertex_type>(world, opts.edgelist_file, fn);
+                });
+            }
+            auto dag_source = [&](auto fn) {
+                if (!opts.dag_file.empty()) {
+                    for_all_edges<vertex_type>(world, opts.dag_file, fn);
+                }
+                for (const auto& [src, dst] : rebuilt) {
+                    fn(src, dst);
+                }
+            };
+
+            have_dag = !opts.condensation.empty();
+            IncrementalResult inserted = insert_edges(world, result, dag_source, [&](auto fn) {
+                for_all_edges<vertex_type>(world, opts.insert_file, fn);
+            }, stats, config, have_dag ? &dag : nullptr, opts.batch_size);
+
+            world.cout0() << "Inserted " << inserted.cross_edges << " edges between SCCs from " << opts.insert_file
+                          << ": re-examined " << inserted.region << " SCCs in " << inserted.iterations << " iterations, merged "
+                          << inserted.merged << " into others" << std::endl;
+
+            if (!opts.checkpoint_dir.empty()) {
+                state.iteration = end_iter;
+                state.unterminated = 0;
+                save_checkpoint(world, opts.checkpoint_dir, state, result);
+                world.cout0() << "Checkpointed the updated SCCs to " << opts.checkpoint_dir << std::endl;
+            }
+        }
+    }
+
+    world.stats_print();
+    stats.print_summary();
+    if (stats.enabled()) {
+        stats.write(opts.stats_file);
+        world.cout0() << "Wrote phase stats to " << opts.stats_file << std::endl;
     }
 
+    uint64_t scc_count = count_sccs(world, result);
+    uint64_t largest_scc = count_largest_scc(world, result);
 
-    std::string edgelist_file = argv[1];
-    ygm::container::map<uint32_t, VtxInfo> result(world);
-    create_vertex_map(world, edgelist_file, result);
-    world.barrier();
+    world.cout0() << "Converged to final SCCs. Enumerated " << scc_count << std::endl;
+    world.cout0() << "Largest SCC contains " << largest_scc << std::endl;
 
+    if (opts.histogram || opts.top_k > 0) {
+        SccSizeSummary summary = summarize_scc_sizes(world, result, opts.top_k);
+        if (opts.histogram) {
+            world.cout0() << "SCC size histogram (size range: SCCs):" << std::endl;
+            for (size_t b = 0; b < summary.histogram.size(); ++b) {
+                if (summary.histogram[b] > 0) {
+                    world.cout0() << "  [" << (uint64_t(1) << b) << ", " << (uint64_t(2) << b) - 1 << "]: "
+                                  << summary.histogram[b] << std::endl;
+                }
+            }
+        }
+        if (opts.top_k > 0) {
+            world.cout0() << "Largest " << summary.top.size() << " SCCs (label: size):" << std::endl;
+            for (const auto& [size, label] : summary.top) {
+                world.cout0() << "  " << label << ": " << size << std::endl;
+            }
+        }
+    }
 
-    uint32_t max_vtx = 0;
-    uint32_t min_vtx = -1;
+    if (!opts.scc_out.empty()) {
+        uint64_t written = write_scc_membership(world, result, opts.scc_out, opts.scc_format == "binary");
+        world.cout0() << "Wrote the SCC of " << written << " vertices to " << opts.scc_out << std::endl;
+    }
 
-    result.for_all([&max_vtx, &min_vtx](const uint32_t& vtx, VtxInfo& info){
-        if (vtx > max_vtx) {
-            max_vtx = vtx;
+    if (!opts.condensation.empty()) {
+        if (!have_dag) {
+            build_condensation(world, result, [&](auto fn) {
+                for_all_edges<vertex_id_t<Graph>>(world, opts.edgelist_file, fn);
+            }, dag, opts.batch_size);
         }
+        uint64_t dag_edges = write_condensation(world, dag, opts.condensation);
+        world.cout0() << "Wrote the condensation DAG (" << dag_edges << " edges between SCCs) to " << opts.condensation
+                      << std::endl;
+    }
 
-        if (vtx < min_vtx) {
-            min_vtx = vtx;
+    return 0;
+}
+
+// Options for graph g of a batch: its edge list, and per-graph names for the outputs that would collide.
+Options batch_input(const Options& opts, size_t g)
+{
+    Options input = opts;
+    input.edgelist_file = opts.batch_files[g];
+    std::string suffix = "-" + std::to_string(g + 1);
+    if (!opts.scc_out.empty()) {
+        input.scc_out = (std::filesystem::path(opts.scc_out) / ("graph" + suffix)).string();
+    }
+    if (!opts.checkpoint_dir.empty()) {
+        input.checkpoint_dir = (std::filesystem::path(opts.checkpoint_dir) / ("graph" + suffix)).string();
+    }
+    for (std::string* file : {&input.stats_file, &input.condensation}) {
+        if (!file->empty()) {
+            std::filesystem::path path(*file);
+            *file = path.replace_filename(path.stem().string() + suffix + path.extension().string()).string();
         }
-    });
+    }
+    return input;
+}
 
-    max_vtx = ygm::max(max_vtx, world);
-    min_vtx = ygm::min(min_vtx, world);
-    world.barrier();
+// Call run_input(options) for the one input, or for every graph of the batch one after the other.
+template <typename RunInput>
+int for_each_input(ygm::comm &world, const Options& opts, RunInput run_input)
+{
+    if (opts.batch_files.empty()) {
+        return run_input(opts);
+    }
 
+    for (size_t g = 0; g < opts.batch_files.size(); ++g) {
+        world.cout0() << "== Graph " << g + 1 << " of " << opts.batch_files.size() << ": " << opts.batch_files[g] << std::endl;
+        double start = wall_seconds();
+        int status = run_input(batch_input(opts, g));
+        if (status != 0) {
+            return status;
+        }
+        world.cout0() << "== Finished " << opts.batch_files[g] << " in " << wall_seconds() - start << " s" << std::endl;
+    }
+    return 0;
+}
 
-    world.cout0() << "Starting DCSC" << std::endl;
+// Solve every graph of the batch in one DCSC pass over their packed union, and report each of them.
+template <typename Graph, typename FromEdges, typename Finalize>
+int run_dcsc_packed(ygm::comm &world, const Options& opts, Graph& graph, FromEdges from_edges, Finalize finalize)
+{
+    using vertex_type = vertex_id_t<Graph>;
+
+    PackedBatch batch = pack_batch<vertex_type>(world, opts.batch_files);
+    world.cout0() << "Packed " << batch.files.size() << " graphs into ids 1.." << batch.offsets.back() << std::endl;
+    from_edges(world, [&](auto fn) { for_all_packed_edges<vertex_type>(world, batch, fn); }, graph, opts.batch_size);
+    world.barrier();
+    finalize(graph);
 
-    size_t iter = 0;
-    size_t unterminated = 1;
+    world.cout0() << "Starting DCSC" << std::endl;
 
+    PhaseRecorder stats(world, !opts.stats_file.empty());
     world.stats_reset();
 
-    while(unterminated) {
-        world.cout0() << "Stopped @ trim-trivial" << std::endl;
-        trim_trivial(world, result);
-        world.cout0() << "Stopped @ init pivots" << std::endl;
-        init_wcc_pivots(world, result, iter, min_vtx, max_vtx);
-        world.cout0() << "Stopped @ prop pivots" << std::endl;
-        prop_pivots(world, result);
-        world.cout0() << "Stopped @ shear edges" << std::endl;
-        shear_edges(world, result);
-        world.cout0() << "Stopped @ detect-term" << std::endl;
-        unterminated = prep_unterminated(world, result);
-        world.cout0() << "Iteration " << iter++ << " left " << unterminated << " unterminated." << std::endl;
-    }
-    
-    world.barrier();
+    DcscConfig config;
+    config.verbose = true;
+    config.fwbw_opening = opts.fwbw;
+    config.engine = opts.engine;
+    config.pivots = opts.pivots;
+    config.trim2 = opts.trim2;
+    config.pipelined = opts.pipeline;
+    config.push_pull = opts.push_pull;
+    config.compact_below = opts.compact_below;
+
+    run_dcsc_iterations(world, graph, stats, config, 0, 1, [](size_t, size_t) {});
 
     world.stats_print();
+    stats.print_summary();
+    if (stats.enabled()) {
+        stats.write(opts.stats_file);
+        world.cout0() << "Wrote phase stats to " << opts.stats_file << std::endl;
+    }
+
+    world.cout0() << "Converged to final SCCs. Enumerated " << count_sccs(world, graph) << std::endl;
+    std::vector<PackedGraphSummary> summaries = summarize_packed_batch(world, graph, batch);
+    for (size_t g = 0; g < summaries.size(); ++g) {
+        world.cout0() << "Graph " << g + 1 << " (" << batch.files[g] << "): " << summaries[g].vertices << " vertices, "
+                      << summaries[g].sccs << " SCCs, largest " << summaries[g].largest << std::endl;
+    }
 
-    uint32_t scc_count = count_sccs(world, result);
-    uint32_t largest_scc = count_largest_scc(world, result);
+    return 0;
+}
 
-    world.cout0() << "Converged to final SCCs. Enumerated " << scc_count << std::endl;
-    world.cout0() << "Largest SCC contains " << largest_scc << std::endl;
-}
\ No newline at end of file
+// Restore the graph from a checkpoint, or build it straight from the edge
+// list (or from the relabeled edges when a partitioner is selected).
+template <typename Graph, typename FromFile, typename FromEdges>
+CheckpointHeader load_graph(ygm::comm &world, const Options& opts, Graph& graph, FromFile from_file, FromEdges from_edges)
+{
+    if (!opts.resume.empty()) {
+        CheckpointHeader state = load_checkpoint(world, opts.resume, opts.layout(), graph);
+        world.cout0() << "Resuming from " << opts.resume << " at iteration " << state.iteration << std::endl;
+        return state;
+    }
+
+    if (opts.partition == "none") {
+        from_file(world, opts.edgelist_file, graph, opts.batch_size);
+        return CheckpointHeader();
+    }
+
+    if constexpr (std::is_same_v<Graph, CsrGraph>) {
+        world.cout0() << "Partitioning " << opts.edgelist_file << " with " << opts.partition << std::endl;
+        VertexPartition part = partition_vertices(world, opts.edgelist_file, [&graph](uint32_t vtx) { return graph.owner(vtx); });
+        world.cout0() << "Edge cut: " << part.cut_before << " before, " << part.cut_after << " after relabeling" << std::endl;
+
+        from_edges(world, [&part](auto fn) {
+            for (const auto& [src, dst] : part.edges) {
+                fn(src, dst);
+            }
+        }, graph, opts.batch_size);
+        // so that the output names the vertices by their input ids
+        graph.input_ids = std::move(part.original);
+    }
+    return CheckpointHeader();
+}
+
+template <typename Info>
+int run_dcsc_map(ygm::comm &world, const Options& opts)
+{
+    ygm::container::map<typename Info::vertex_type, Info> result(world);
+    if (opts.batch_pack) {
+        return run_dcsc_packed(world, opts, result, [](auto&&... args) { create_vertex_map_from_edges(args...); },
+                               [](auto&) {});
+    }
+
+    return for_each_input(world, opts, [&](const Options& input) {
+        CheckpointHeader state = load_graph(world, input, result,
+                                            [](auto&... args) { create_vertex_map(args...); },
+                                            [](auto&&... args) { create_vertex_map_from_edges(args...); });
+        world.barrier();
+
+        int status = run_dcsc(world, input, result, state);
+        // the next graph of a batch is built into the same map
+        if (!opts.batch_files.empty()) {
+            result.clear();
+        }
+        return status;
+    });
+}
+
+template <typename VertexId>
+int run_dcsc_map_ids(ygm::comm &world, const Options& opts)
+{
+    if (opts.adjacency == "set") {
+        return run_dcsc_map<BasicVtxInfo<BasicSetAdjacency<VertexId>>>(world, opts);
+    } else if (opts.adjacency == "vector") {
+        return run_dcsc_map<BasicVtxInfo<BasicSortedVecAdjacency<VertexId>>>(world, opts);
+    } else if (opts.adjacency == "varint") {
+        return run_dcsc_map<BasicVtxInfo<BasicVarintAdjacency<VertexId>>>(world, opts);
+    }
+
+    if (world.rank0()) {
+        std::cerr << "Unknown adjacency '" << opts.adjacency << "'" << std::endl;
+    }
+    return 1;
+}
+
+int run_dcsc_csr(ygm::comm &world, const Options& opts)
+{
+    auto mirror_hubs = [&world, &opts](CsrGraph& graph) {
+        if (opts.hub_degree > 0) {
+            graph.mirror_hubs(opts.hub_degree);
+            world.cout0() << "Mirroring " << graph.hubs.size() << " hubs of degree >= " << opts.hub_degree << std::endl;
+        }
+    };
+
+    if (opts.batch_pack) {
+        CsrGraph result(world);
+        return run_dcsc_packed(world, opts, result, [](auto&&... args) { create_csr_graph_from_edges(args...); },
+                               mirror_hubs);
+    }
+
+    // a CsrGraph is finalized once, so every graph of a batch gets its own
+    return for_each_input(world, opts, [&](const Options& input) {
+        CsrGraph result(world);
+        CheckpointHeader state = load_graph(world, input, result,
+                                            [](auto&... args) { create_csr_graph(args...); },
+                                            [](auto&&... args) { create_csr_graph_from_edges(args...); });
+        world.barrier();
+        mirror_hubs(result);
+
+        return run_dcsc(world, input, result, state);
+    });
+}
+
+int main(int argc, char **argv)
+{
+    ygm::comm world(&argc, &argv);
+
+    Options opts;
+    bool bad_args = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--graph" && i + 1 < argc) {
+            opts.graph = argv[++i];
+        } else if (arg == "--adjacency" && i + 1 < argc) {
+            opts.adjacency = argv[++i];
+        } else if (arg == "--partition" && i + 1 < argc) {
+            opts.partition = argv[++i];
+        } else if (arg == "--batch-size" && i + 1 < argc) {
+            opts.batch_size = std::stoul(argv[++i]);
+        } else if (arg == "--checkpoint-dir" && i + 1 < argc) {
+            opts.checkpoint_dir = argv[++i];
+        } else if (arg == "--checkpoint-every" && i + 1 < argc) {
+            opts.checkpoint_every = std::stoul(argv[++i]);
+        } else if (arg == "--resume" && i + 1 < argc) {
+            opts.resume = argv[++i];
+        } else if (arg == "--engine" && i + 1 < argc) {
+            opts.engine = argv[++i];
+        } else if (arg == "--pivots" && i + 1 < argc) {
+            opts.pivots = argv[++i];
+        } else if (arg == "--trim2") {
+            opts.trim2 = true;
+        } else if (arg == "--pipeline") {
+            opts.pipeline = true;
+        } else if (arg == "--push-pull") {
+            opts.push_pull = true;
+        } else if (arg == "--compact" && i + 1 < argc) {
+            opts.compact_below = std::stod(argv[++i]);
+        } else if (arg == "--hub-degree" && i + 1 < argc) {
+            opts.hub_degree = std::stoul(argv[++i]);
+        } else if (arg == "--ids" && i + 1 < argc) {
+            opts.ids = std::stoul(argv[++i]);
+        } else if (arg == "--scc-out" && i + 1 < argc) {
+            opts.scc_out = argv[++i];
+        } else if (arg == "--scc-format" && i + 1 < argc) {
+            opts.scc_format = argv[++i];
+        } else if (arg == "--condensation" && i + 1 < argc) {
+            opts.condensation = argv[++i];
+        } else if (arg == "--insert" && i + 1 < argc) {
+            opts.insert_file = argv[++i];
+        } else if (arg == "--dag" && i + 1 < argc) {
+            opts.dag_file = argv[++i];
+        } else if (arg == "--histogram") {
+            opts.histogram = true;
+        } else if (arg == "--top-k" && i + 1 < argc) {
+            opts.top_k = std::stoul(argv[++i]);
+        } else if (arg == "--fwbw") {
+            opts.fwbw = true;
+        } else if (arg == "--stats-out" && i + 1 < argc) {
+            opts.stats_file = argv[++i];
+        } else if (arg == "--batch" && i + 1 < argc) {
+            opts.batch_file = argv[++i];
+        } else if (arg == "--batch-pack") {
+            opts.batch_pack = true;
+        } else if (opts.edgelist_file.empty()) {
+            opts.edgelist_file = arg;
+        } else {
+            bad_args = true;
+        }
+    }
+
+    const bool have_input = !opts.edgelist_file.empty() || !opts.resume.empty();
+    if (bad_args || have_input == !opts.batch_file.empty() || (opts.batch_pack && opts.batch_file.empty()) ||
+        opts.checkpoint_every == 0 ||
+        opts.compact_below < 0 || opts.compact_below > 1) {
+        if (world.rank0()) {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--graph map|csr] [--adjacency set|vector|varint] [--partition none|ldg]"
+                      << " [--batch-size N] [--checkpoint-dir DIR] [--checkpoint-every N]"
+                      << " [--stats-out FILE.csv|FILE.json] [--fwbw] [--trim2] [--pipeline] [--push-pull]"
+                      << " [--compact FRACTION] [--engine pivot|coloring] [--pivots random|degree] [--hub-degree N] [--ids 32|64]"
+                      << " [--scc-out DIR] [--scc-format text|binary] [--histogram] [--top-k K] [--condensation FILE]"
+                      << " [--insert EDGES [--dag FILE]]"
+                      << " <edgelist_file | --resume CHECKPOINT | --batch MANIFEST [--batch-pack]>" << std::endl;
+        }
+        return 1;
+    }
+
+    if (!opts.batch_file.empty()) {
+        try {
+            opts.batch_files = read_batch_manifest(opts.batch_file);
+        } catch (const std::runtime_error& e) {
+            if (world.rank0()) {
+                std::cerr << e.what() << std::endl;
+            }
+            return 1;
+        }
+
+        if (!opts.insert_file.empty()) {
+            if (world.rank0()) {
+                std::cerr << "--insert updates a single graph and cannot be used with --batch" << std::endl;
+            }
+            return 1;
+        }
+        if (opts.batch_pack && (!opts.scc_out.empty() || !opts.condensation.empty() || !opts.checkpoint_dir.empty() ||
+                                opts.partition != "none" || opts.histogram || opts.top_k > 0)) {
+            if (world.rank0()) {
+                std::cerr << "--batch-pack reports SCC counts per graph only; drop --scc-out, --condensation,"
+                          << " --checkpoint-dir, --partition, --histogram and --top-k" << std::endl;
+            }
+            return 1;
+        }
+    }
+
+    if (opts.partition != "none" && opts.partition != "ldg") {
+        if (world.rank0()) {
+            std::cerr << "Unknown partition '" << opts.partition << "'" << std::endl;
+        }
+        return 1;
+    }
+
+    // the map places vertices by hash, so it would not keep the parts
+    if (opts.partition == "ldg" && opts.graph != "csr") {
+        if (world.rank0()) {
+            std::cerr << "--partition ldg needs --graph csr" << std::endl;
+        }
+        return 1;
+    }
+
+    if (opts.engine != "pivot" && opts.engine != "coloring") {
+        if (world.rank0()) {
+            std::cerr << "Unknown engine '" << opts.engine << "'" << std::endl;
+        }
+        return 1;
+    }
+
+    PivotPolicy policy;
+    if (!parse_pivot_policy(opts.pivots, policy)) {
+        if (world.rank0()) {
+            std::cerr << "Unknown pivot policy '" << opts.pivots << "'" << std::endl;
+        }
+        return 1;
+    }
+
+    if (opts.scc_format != "text" && opts.scc_format != "binary") {
+        if (world.rank0()) {
+            std::cerr << "Unknown SCC output format '" << opts.scc_format << "'" << std::endl;
+        }
+        return 1;
+    }
+
+    const bool dag_from_file = !opts.insert_file.empty() && !opts.dag_file.empty();
+    if ((!opts.condensation.empty() || !opts.insert_file.empty()) && !dag_from_file &&
+        ((opts.edgelist_file.empty() && opts.batch_files.empty()) || opts.partition != "none")) {
+        if (world.rank0()) {
+            std::cerr << "--condensation and --insert reread the edge list and need it with --partition none,"
+                      << " unless --insert comes with --dag" << std::endl;
+        }
+        return 1;
+    }
+
+    if (!opts.insert_file.empty() && (opts.graph != "map" || opts.partition != "none")) {
+        if (world.rank0()) {
+            std::cerr << "--insert needs --graph map and --partition none" << std::endl;
+        }
+        return 1;
+    }
+
+    if (opts.ids != 32 && opts.ids != 64) {
+        if (world.rank0()) {
+            std::cerr << "--ids must be 32 or 64" << std::endl;
+        }
+        return 1;
+    }
+
+    if (opts.graph == "csr" && opts.ids != 32) {
+        if (world.rank0()) {
+            std::cerr << "--ids 64 needs --graph map" << std::endl;
+        }
+        return 1;
+    } else if (opts.graph != "map" && opts.graph != "csr") {
+        if (world.rank0()) {
+            std::cerr << "Unknown graph '" << opts.graph << "'" << std::endl;
+        }
+        return 1;
+    }
+
+    if (opts.hub_degree > 0 && opts.graph != "csr") {
+        if (world.rank0()) {
+            std::cerr << "--hub-degree needs --graph csr" << std::endl;
+        }
+        return 1;
+    }
+
+    // ids too large for the vertex id type or too sparse for the CSR layout only show up while the graph is
+    // built; every rank throws these together
+    auto report = [&world](const std::exception& e) {
+        if (world.rank0()) {
+            std::cerr << e.what() << std::endl;
+        }
+        return 1;
+    };
+    try {
+        if (opts.graph == "csr") {
+            return run_dcsc_csr(world, opts);
+        }
+        return opts.ids == 64 ? run_dcsc_map_ids<uint64_t>(world, opts) : run_dcsc_map_ids<uint32_t>(world, opts);
+    } catch (const std::overflow_error& e) {
+        return report(e);
+    } catch (const std::length_error& e) {
+        return report(e);
+    }
+}